@@ -104,15 +104,15 @@ if "%cmake%"=="1"   (
 
 :: Compile/Link Line Definitions
 :: ----------------------------------------------------------------------------
-set cc_common=  -I"raylib\include" -Wall -std=c99 -D_DEFAULT_SOURCE -Wno-missing-braces -Wunused-result -Wextra -Wmissing-prototypes -Wstrict-prototypes
-set cc_link=    -L"raylib\lib\windows" -lraylib -lopengl32 -lgdi32 -lwinmm
+set cc_common=  -I"raylib\include" -Wall -std=c99 -D_DEFAULT_SOURCE -Wno-missing-braces -Wunused-result -Wextra -Wmissing-prototypes -Wstrict-prototypes -DPONG_FIXED_CONFIG
+set cc_link=    -L"raylib\lib\windows" -lraylib -lopengl32 -lgdi32 -lwinmm -lws2_32
 set cc_debug=   -g -O0
 set cc_release= -O3
 set cc_web= -sUSE_GLFW=3 -sFORCE_FILESYSTEM=1 -sASYNCIFY -DPLATFORM_WEB -sEXPORTED_FUNCTIONS=_main,requestFullscreen -sTOTAL_MEMORY=67108864 -sEXPORTED_RUNTIME_METHODS=HEAPF32 --shell-file "%web_shell%"
 set cc_weblink= -L"raylib\lib\web" -lraylib
 set cc_out=     -o
-set cl_common=  cl /I"raylib\include" /W3 /MD /Zi
-set cl_link=    /link /INCREMENTAL:NO /LIBPATH:"raylib\lib\windows-msvc" raylib.lib gdi32.lib winmm.lib user32.lib shell32.lib
+set cl_common=  cl /I"raylib\include" /W3 /MD /Zi /DPONG_FIXED_CONFIG
+set cl_link=    /link /INCREMENTAL:NO /LIBPATH:"raylib\lib\windows-msvc" raylib.lib gdi32.lib winmm.lib user32.lib shell32.lib ws2_32.lib
 set cl_debug=   -Od /DEBUG
 set cl_release= -O3
 set cl_out=     /out:
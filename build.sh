@@ -107,7 +107,7 @@ script_choose_cmake_lines()
 script_choose_simple_lines()
 {
     # Line Definitions
-    cc_common='-I"raylib/include" -Wall -std=c99 -D_DEFAULT_SOURCE -Wno-missing-braces -Wunused-result -Wextra -Wmissing-prototypes -Wstrict-prototypes'
+    cc_common='-I"raylib/include" -Wall -std=c99 -D_DEFAULT_SOURCE -Wno-missing-braces -Wunused-result -Wextra -Wmissing-prototypes -Wstrict-prototypes -DPONG_FIXED_CONFIG'
     cc_link='-lraylib -lGL -lm -lpthread -ldl -lrt -lX11'
     cc_debug='-g -O0'
     cc_release='-O3'
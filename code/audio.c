@@ -0,0 +1,293 @@
+// EXPLANATION:
+// The game's beeps, mixed on raylib's audio thread
+// See audio.h for more documentation/descriptions
+
+#include "audio.h"
+
+#include <limits.h> // for SHRT_MAX
+#include <math.h> // for lrintf()
+#include <stddef.h> // for NULL
+#include <string.h> // for memset()
+
+// SSE2 is always there on x86-64, so it's picked at compile time like the batch kernels
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #include <emmintrin.h>
+    #define AUDIO_SIMD_SSE2
+#endif
+
+#define AUDIO_MIX_BLOCK 256 // Samples summed as floats before they're converted
+#define AUDIO_PHASE_TO_TURNS (1.0f / 4294967296.0f) // Phase accumulator to turns, read as signed it's -0.5 to 0.5
+
+// The queue indexes are shared between threads, so they're read and written
+// with acquire/release ordering: an event is filled in before its index is published
+#if defined(_MSC_VER)
+    #include <intrin.h>
+    #define AUDIO_LOAD_ACQUIRE(index) ((unsigned int)_InterlockedOr((volatile long *)(index), 0))
+    #define AUDIO_STORE_RELEASE(index, value) _InterlockedExchange((volatile long *)(index), (long)(value))
+#else
+    #define AUDIO_LOAD_ACQUIRE(index) __atomic_load_n((index), __ATOMIC_ACQUIRE)
+    #define AUDIO_STORE_RELEASE(index, value) __atomic_store_n((index), (value), __ATOMIC_RELEASE)
+#endif
+
+// Types and Structures
+// --------------------------------------------------------------------------------
+typedef struct BeepTone
+{
+    float frequency; // Hz, at a pitch of 1
+    float attack;    // Seconds up to full volume
+    float decay;     // Seconds down to the sustain level
+    float sustain;   // Level, 0 to 1
+    float hold;      // Seconds at the sustain level
+    float release;   // Seconds down to silence
+} BeepTone;
+
+// Local Variables Definition
+// --------------------------------------------------------------------------------
+// Same lengths as the old baked beeps, with a bit of punch at the start
+static const BeepTone beepTones[BEEP_COUNT] = {
+    [BEEP_MENU]   = { 200.0f, 0.003f, 0.010f, 0.7f, 0.010f, 0.007f },
+    [BEEP_PADDLE] = { 450.0f, 0.004f, 0.020f, 0.8f, 0.061f, 0.015f },
+    [BEEP_EDGE]   = { 500.0f, 0.004f, 0.020f, 0.8f, 0.061f, 0.015f },
+    [BEEP_SCORE]  = { 600.0f, 0.005f, 0.050f, 0.7f, 0.295f, 0.050f },
+};
+
+static PongAudio *activeAudio = NULL; // raylib's stream callback doesn't take a user pointer
+
+// Local Functions Declaration
+// --------------------------------------------------------------------------------
+static void PongAudioCallback(void *bufferData, unsigned int frames); // Runs on the audio thread
+static void StartAudioStage(AudioVoice *voice, const BeepTone *tone, AudioStage stage);
+static void MixAudioVoice(AudioVoice *voice, const BeepTone *tone, float *mix, int count);
+static void RenderAudioVoice(AudioVoice *voice, float *mix, int count); // Within one stage, the envelope is a straight line
+static void ConvertAudioSamples(const float *mix, short *samples, int count);
+static inline float AudioSine(float turns); // sin(2*PI*turns), turns from -0.5 to 0.5
+
+bool LoadPongAudio(PongAudio *audio)
+{
+    *audio = (PongAudio){ 0 };
+    if (!IsAudioDeviceReady() || activeAudio != NULL)
+        return false;
+
+    SetAudioStreamBufferSizeDefault(AUDIO_BUFFER_FRAMES);
+    audio->stream = LoadAudioStream(AUDIO_SAMPLE_RATE, 16, 1);
+    if (!IsAudioStreamValid(audio->stream))
+        return false;
+
+    activeAudio = audio;
+    SetAudioStreamCallback(audio->stream, PongAudioCallback);
+    PlayAudioStream(audio->stream);
+    audio->isReady = true;
+
+    return true;
+}
+
+void UnloadPongAudio(PongAudio *audio)
+{
+    if (!audio->isReady)
+        return;
+
+    // The callback can't run again once the stream is gone
+    StopAudioStream(audio->stream);
+    UnloadAudioStream(audio->stream);
+    activeAudio = NULL;
+    audio->isReady = false;
+}
+
+void PlayBeep(PongAudio *audio, PongBeep beep, float pitch)
+{
+    if (audio == NULL)
+        return;
+
+    // Only this side writes the head, so it can be read plainly
+    unsigned int head = audio->queueHead;
+    if (head - AUDIO_LOAD_ACQUIRE(&audio->queueTail) >= AUDIO_QUEUE_SIZE)
+    {
+        audio->droppedEvents++; // The mixer is far behind, a missed beep beats waiting on it
+        return;
+    }
+
+    if (!(pitch >= AUDIO_MIN_PITCH)) // NaN too
+        pitch = AUDIO_MIN_PITCH;
+    if (pitch > AUDIO_MAX_PITCH)
+        pitch = AUDIO_MAX_PITCH;
+
+    audio->queue[head % AUDIO_QUEUE_SIZE] = (AudioEvent){ .beep = beep, .pitch = pitch };
+    AUDIO_STORE_RELEASE(&audio->queueHead, head + 1);
+}
+
+void MixPongAudio(PongAudio *audio, short *samples, int frameCount)
+{
+    // Start the beeps that came in since the last buffer
+    unsigned int tail = audio->queueTail;
+    unsigned int head = AUDIO_LOAD_ACQUIRE(&audio->queueHead);
+    for (; tail != head; tail++)
+    {
+        const AudioEvent *event = &audio->queue[tail % AUDIO_QUEUE_SIZE];
+        const BeepTone *tone = &beepTones[event->beep];
+        AudioVoice *voice = &audio->voices[event->beep];
+
+        // Restarting keeps the level and phase it was at, so a quick repeat doesn't click
+        if (voice->stage == AUDIO_STAGE_OFF)
+            voice->phase = 0;
+        voice->phaseStep = (uint32_t)(tone->frequency * event->pitch / AUDIO_SAMPLE_RATE * 4294967296.0);
+        StartAudioStage(voice, tone, AUDIO_STAGE_ATTACK);
+    }
+    AUDIO_STORE_RELEASE(&audio->queueTail, tail);
+
+    bool isSilent = true;
+    for (int v = 0; v < BEEP_COUNT; v++)
+        isSilent &= (audio->voices[v].stage == AUDIO_STAGE_OFF);
+    if (isSilent)
+    {
+        memset(samples, 0, frameCount * sizeof(short)); // Most buffers, between beeps
+        return;
+    }
+
+    float mix[AUDIO_MIX_BLOCK];
+    for (int start = 0; start < frameCount; start += AUDIO_MIX_BLOCK)
+    {
+        int count = frameCount - start;
+        if (count > AUDIO_MIX_BLOCK)
+            count = AUDIO_MIX_BLOCK;
+
+        memset(mix, 0, count * sizeof(float));
+        for (int v = 0; v < BEEP_COUNT; v++)
+            MixAudioVoice(&audio->voices[v], &beepTones[v], mix, count);
+        ConvertAudioSamples(mix, &samples[start], count);
+    }
+}
+
+static void PongAudioCallback(void *bufferData, unsigned int frames)
+{
+    if (activeAudio != NULL)
+        MixPongAudio(activeAudio, (short *)bufferData, (int)frames);
+}
+
+static void StartAudioStage(AudioVoice *voice, const BeepTone *tone, AudioStage stage)
+{
+    float seconds = 0.0f;
+    float target = 0.0f;
+    switch (stage)
+    {
+        case AUDIO_STAGE_ATTACK:  seconds = tone->attack;  target = 1.0f;          break;
+        case AUDIO_STAGE_DECAY:   seconds = tone->decay;   target = tone->sustain; break;
+        case AUDIO_STAGE_SUSTAIN: seconds = tone->hold;    target = tone->sustain; break;
+        case AUDIO_STAGE_RELEASE: seconds = tone->release; target = 0.0f;          break;
+        default:
+            *voice = (AudioVoice){ 0 };
+            return;
+    }
+
+    voice->stage = stage;
+    voice->stageFrames = (int)(seconds * AUDIO_SAMPLE_RATE);
+    if (voice->stageFrames < 1)
+        voice->stageFrames = 1;
+    voice->envelopeStep = (target - voice->envelope) / voice->stageFrames;
+}
+
+static void MixAudioVoice(AudioVoice *voice, const BeepTone *tone, float *mix, int count)
+{
+    int position = 0;
+    while (position < count && voice->stage != AUDIO_STAGE_OFF)
+    {
+        int run = count - position;
+        if (run > voice->stageFrames)
+            run = voice->stageFrames;
+
+        RenderAudioVoice(voice, &mix[position], run);
+        position += run;
+        voice->stageFrames -= run;
+        if (voice->stageFrames == 0)
+            StartAudioStage(voice, tone, (AudioStage)(voice->stage + 1));
+    }
+}
+
+static void RenderAudioVoice(AudioVoice *voice, float *mix, int count)
+{
+    uint32_t phase = voice->phase;
+    uint32_t phaseStep = voice->phaseStep;
+    float envelope = voice->envelope;
+    float envelopeStep = voice->envelopeStep;
+    int i = 0;
+
+#if defined(AUDIO_SIMD_SSE2)
+    // Four samples at once, each lane a step further along
+    __m128i phases = _mm_add_epi32(_mm_set1_epi32((int)phase),
+                                   _mm_set_epi32((int)(phaseStep * 3), (int)(phaseStep * 2), (int)phaseStep, 0));
+    __m128i phaseAdvance = _mm_set1_epi32((int)(phaseStep * 4));
+    __m128 envelopes = _mm_add_ps(_mm_set1_ps(envelope),
+                                  _mm_mul_ps(_mm_set1_ps(envelopeStep), _mm_set_ps(3.0f, 2.0f, 1.0f, 0.0f)));
+    __m128 envelopeAdvance = _mm_set1_ps(envelopeStep * 4.0f);
+
+    const __m128 toTurns = _mm_set1_ps(AUDIO_PHASE_TO_TURNS);
+    const __m128 signMask = _mm_set1_ps(-0.0f);
+    const __m128 quarter = _mm_set1_ps(0.25f);
+    const __m128 twoPi = _mm_set1_ps(2.0f * PI);
+    for (; i + 4 <= count; i += 4)
+    {
+        // Same math as AudioSine(), folded to a quarter turn then a polynomial
+        __m128 turns = _mm_mul_ps(_mm_cvtepi32_ps(phases), toTurns);
+        __m128 sign = _mm_and_ps(turns, signMask);
+        __m128 fold = _mm_sub_ps(quarter, _mm_andnot_ps(signMask, _mm_sub_ps(quarter, _mm_andnot_ps(signMask, turns))));
+        __m128 x = _mm_or_ps(_mm_mul_ps(fold, twoPi), sign);
+        __m128 x2 = _mm_mul_ps(x, x);
+        __m128 wave = _mm_add_ps(_mm_set1_ps(-1.0f / 5040.0f), _mm_mul_ps(x2, _mm_set1_ps(1.0f / 362880.0f)));
+        wave = _mm_add_ps(_mm_set1_ps(1.0f / 120.0f), _mm_mul_ps(x2, wave));
+        wave = _mm_add_ps(_mm_set1_ps(-1.0f / 6.0f), _mm_mul_ps(x2, wave));
+        wave = _mm_add_ps(_mm_set1_ps(1.0f), _mm_mul_ps(x2, wave));
+        wave = _mm_mul_ps(x, wave);
+
+        _mm_storeu_ps(&mix[i], _mm_add_ps(_mm_loadu_ps(&mix[i]), _mm_mul_ps(wave, envelopes)));
+        phases = _mm_add_epi32(phases, phaseAdvance);
+        envelopes = _mm_add_ps(envelopes, envelopeAdvance);
+    }
+    phase += phaseStep * (uint32_t)i;
+    envelope += envelopeStep * i;
+#endif
+
+    for (; i < count; i++)
+    {
+        mix[i] += AudioSine((float)(int32_t)phase * AUDIO_PHASE_TO_TURNS) * envelope;
+        phase += phaseStep;
+        envelope += envelopeStep;
+    }
+
+    voice->phase = phase;
+    voice->envelope = envelope;
+}
+
+static void ConvertAudioSamples(const float *mix, short *samples, int count)
+{
+    const float scale = AUDIO_VOLUME * SHRT_MAX;
+    int i = 0;
+
+#if defined(AUDIO_SIMD_SSE2)
+    // Packing saturates, so there's no clamp to do
+    const __m128 scales = _mm_set1_ps(scale);
+    for (; i + 8 <= count; i += 8)
+    {
+        __m128i low = _mm_cvtps_epi32(_mm_mul_ps(_mm_loadu_ps(&mix[i]), scales));
+        __m128i high = _mm_cvtps_epi32(_mm_mul_ps(_mm_loadu_ps(&mix[i + 4]), scales));
+        _mm_storeu_si128((__m128i *)&samples[i], _mm_packs_epi32(low, high));
+    }
+#endif
+
+    for (; i < count; i++)
+    {
+        float sample = mix[i] * scale;
+        if (sample > SHRT_MAX)
+            sample = SHRT_MAX;
+        if (sample < -SHRT_MAX - 1)
+            sample = -SHRT_MAX - 1;
+        samples[i] = (short)lrintf(sample);
+    }
+}
+
+static inline float AudioSine(float turns)
+{
+    // Fold to -0.25 to 0.25 turns (where sin is odd and close to a polynomial), Taylor to x^9
+    float fold = 0.25f - fabsf(0.25f - fabsf(turns));
+    float x = (turns < 0.0f) ? -fold * 2.0f * PI : fold * 2.0f * PI;
+    float x2 = x * x;
+    return x * (1.0f + x2 * (-1.0f / 6.0f + x2 * (1.0f / 120.0f + x2 * (-1.0f / 5040.0f + x2 * (1.0f / 362880.0f)))));
+}
@@ -0,0 +1,34 @@
+// EXPLANATION:
+// The game's beeps, mixed on raylib's audio thread instead of played as Sounds
+// Game code only pushes an event onto a lock-free queue with PlayBeep(), which
+// never blocks or calls into the audio device. The AudioStream callback drains the
+// queue and synthesizes each beep as it plays, so nothing is generated at startup
+// Games without a PongAudio (NULL) are silent, so headless runs skip audio entirely
+//
+// Each beep is a sine oscillator (a 32 bit phase accumulator) shaped by an ADSR
+// envelope, and can be played at any pitch: the game raises the bounce beeps as
+// the rally speeds up. Voices are generated in blocks, 4 samples at a time with
+// SSE2 where it's there, using a polynomial sine instead of calling sinf() per sample
+
+#ifndef PONG_AUDIO_HEADER_GUARD
+#define PONG_AUDIO_HEADER_GUARD
+
+#include "raylib.h"
+#include "states.h" // for PongAudio
+
+// Macros
+// --------------------------------------------------------------------------------
+#define AUDIO_SAMPLE_RATE 44100
+#define AUDIO_BUFFER_FRAMES 512 // Per stream buffer, about 12 ms
+#define AUDIO_VOLUME 0.25f
+#define AUDIO_MIN_PITCH 0.5f // PlayBeep() keeps pitches within an octave either way
+#define AUDIO_MAX_PITCH 2.0f
+
+// Prototypes
+// --------------------------------------------------------------------------------
+bool LoadPongAudio(PongAudio *audio); // Needs the audio device, and audio must stay put until it's unloaded. One at a time
+void UnloadPongAudio(PongAudio *audio);
+void PlayBeep(PongAudio *audio, PongBeep beep, float pitch); // Pitch multiplies the beep's frequency. Safe to call every step, does nothing without audio
+void MixPongAudio(PongAudio *audio, short *samples, int frameCount); // Mono 16 bit, called by the stream (or by hand, to test)
+
+#endif // PONG_AUDIO_HEADER_GUARD
@@ -0,0 +1,530 @@
+// EXPLANATION:
+// Runs many headless matches at once, for AI tuning and other bulk simulation
+// See batch.h for more documentation/descriptions
+
+#include "batch.h"
+
+#include <stddef.h> // for size_t
+#include <stdint.h> // for uintptr_t
+#include "raylib.h"
+
+#include "config.h"
+#include "pong.h" // shares the game's rules and collision code
+#include "rng.h"
+
+// SIMD kernels are picked at runtime, see GetBestPongBatchKernel()
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #include <immintrin.h>
+    #define BATCH_SIMD_SSE2
+    #define BATCH_SELECT_SSE2(mask, a, b) _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b))
+    #if defined(__GNUC__) || defined(__clang__) // needs per-function targets and cpu detection
+        #define BATCH_SIMD_AVX2
+        #define BATCH_TARGET_AVX2 __attribute__((target("avx2")))
+    #endif
+#endif
+
+#define BATCH_SWEEP_MARGIN 1.0f // Pixels around the ball's path where the SIMD kernels leave it to the scalar code
+#define BATCH_ARRAY_STAGGER 64 // Bytes between arrays, one cache line
+
+// Local Functions Declaration
+// --------------------------------------------------------------------------------
+static void StartPongBatchMatch(PongBatch *batch, int index, unsigned int seed); // Same as InitGameState()
+static float GetPongBatchPaddleX(const PongConfig *rules, bool paddleIsLeft); // Same as InitGameState()
+static Ball LoadPongBatchBall(const PongBatch *batch, int index);
+static Paddle LoadPongBatchPaddle(const PongBatch *batch, int index, bool paddleIsLeft);
+static void StorePongBatchPaddle(PongBatch *batch, int index, bool paddleIsLeft, const Paddle *paddle);
+static void UpdatePongBatchPaddles(PongBatch *batch, float deltaTime); // Computer and player paddles, shared by every kernel
+static void StepPongBatchMatch(PongBatch *batch, int index, float deltaTime); // Everything after the paddles for one match, through StepPong()'s own functions
+
+PongBatch InitPongBatch(int count, unsigned int seed, const PongConfig *config)
+{
+    PongBatch batch = { 0 };
+    int floatsPerLine = BATCH_ALIGNMENT / sizeof(float);
+    batch.count = count;
+    batch.kernel = GetBestPongBatchKernel();
+    batch.capacity = (count + floatsPerLine - 1) / floatsPerLine * floatsPerLine;
+    batch.computerL = true;
+    batch.computerR = true;
+    batch.config = (config != NULL) ? config : &defaultPongConfig;
+    batch.ai = GetComputerAi(DIFFICULTY_MEDIUM, batch.config);
+
+    // Every array has the same length and is 4 bytes per element,
+    // so they can all be carved out of one aligned block
+    // The random generators are 16 bytes each, so they go at the end
+    // The stagger stops a match's entries in every array from being exactly 4 KB
+    // apart (1024 matches), where they'd all fight over the same cache set
+    const int arrayCount = 26;
+    size_t arraySize = (size_t)batch.capacity * sizeof(float) + BATCH_ARRAY_STAGGER;
+    size_t rngSize = (size_t)batch.capacity * sizeof(PongRng);
+    batch.memory = MemAlloc((unsigned int)(arraySize * arrayCount + rngSize + BATCH_ALIGNMENT));
+    uintptr_t address = ((uintptr_t)batch.memory + BATCH_ALIGNMENT - 1) & ~(uintptr_t)(BATCH_ALIGNMENT - 1);
+    char *next = (char *)address;
+
+    batch.ballX          = (float *)next; next += arraySize;
+    batch.ballY          = (float *)next; next += arraySize;
+    batch.ballDirX       = (float *)next; next += arraySize;
+    batch.ballDirY       = (float *)next; next += arraySize;
+    batch.ballSpeed      = (float *)next; next += arraySize;
+    batch.paddleHits     = (int *)next;   next += arraySize;
+    batch.trajectoryId   = (unsigned int *)next; next += arraySize;
+    batch.paddleLY       = (float *)next; next += arraySize;
+    batch.paddleRY       = (float *)next; next += arraySize;
+    batch.paddleLSpeed   = (float *)next; next += arraySize;
+    batch.paddleRSpeed   = (float *)next; next += arraySize;
+    batch.nextHitPosL    = (float *)next; next += arraySize;
+    batch.nextHitPosR    = (float *)next; next += arraySize;
+    batch.predictionIdL  = (unsigned int *)next; next += arraySize;
+    batch.predictionIdR  = (unsigned int *)next; next += arraySize;
+    batch.targetYL       = (float *)next; next += arraySize;
+    batch.targetYR       = (float *)next; next += arraySize;
+    batch.nextTargetYL   = (float *)next; next += arraySize;
+    batch.nextTargetYR   = (float *)next; next += arraySize;
+    batch.reactionTimerL = (float *)next; next += arraySize;
+    batch.reactionTimerR = (float *)next; next += arraySize;
+    batch.scoreTimer     = (float *)next; next += arraySize;
+    batch.scoreL         = (int *)next;   next += arraySize;
+    batch.scoreR         = (int *)next;   next += arraySize;
+    batch.winsL          = (unsigned int *)next; next += arraySize;
+    batch.winsR          = (unsigned int *)next; next += arraySize;
+    batch.rng            = (PongRng *)next;
+
+    // Match i plays like a game started with InitGameState(seed + i)
+    for (int i = 0; i < count; i++)
+        StartPongBatchMatch(&batch, i, seed + (unsigned int)i);
+
+    return batch;
+}
+
+void FreePongBatch(PongBatch *batch)
+{
+    MemFree(batch->memory);
+    *batch = (PongBatch){ 0 };
+}
+
+void ResetPongBatchMatch(PongBatch *batch, int index)
+{
+    // Next match's seed comes from this one, same as StepPong()
+    StartPongBatchMatch(batch, index, NextPongRng(&batch->rng[index]));
+}
+
+void SetPongBatchDifficulty(PongBatch *batch, GameDifficulty difficulty)
+{
+    batch->ai = GetComputerAi(difficulty, batch->config);
+}
+
+static void StartPongBatchMatch(PongBatch *batch, int index, unsigned int seed)
+{
+    GameState pong = InitGameState(seed, NULL, batch->config);
+
+    batch->ballX[index] = pong.ball.position.x;
+    batch->ballY[index] = pong.ball.position.y;
+    batch->ballDirX[index] = pong.ball.direction.x;
+    batch->ballDirY[index] = pong.ball.direction.y;
+    batch->ballSpeed[index] = pong.ball.speed;
+    batch->paddleHits[index] = pong.ball.paddleHits;
+    batch->trajectoryId[index] = pong.ball.trajectoryId;
+
+    pong.paddleL.speed = 0.0f; // Player paddles stand still until told to move
+    pong.paddleR.speed = 0.0f;
+    StorePongBatchPaddle(batch, index, true, &pong.paddleL);
+    StorePongBatchPaddle(batch, index, false, &pong.paddleR);
+
+    batch->scoreTimer[index] = pong.scoreTimer;
+    batch->scoreL[index] = pong.scoreL;
+    batch->scoreR[index] = pong.scoreR;
+    batch->rng[index] = pong.rng;
+}
+
+static float GetPongBatchPaddleX(const PongConfig *rules, bool paddleIsLeft)
+{
+    return paddleIsLeft ? (float)(rules->paddleWidth * 1.5) : (float)(RENDER_WIDTH - rules->paddleWidth * 2.5);
+}
+
+static Ball LoadPongBatchBall(const PongBatch *batch, int index)
+{
+    Ball ball =
+    {
+        .position = { batch->ballX[index], batch->ballY[index] },
+        .direction = { batch->ballDirX[index], batch->ballDirY[index] },
+        .speed = batch->ballSpeed[index],
+        .size = PONG_CONFIG(batch->config)->ballSize,
+        .paddleHits = batch->paddleHits[index],
+        .trajectoryId = batch->trajectoryId[index],
+    };
+    return ball;
+}
+
+static Paddle LoadPongBatchPaddle(const PongBatch *batch, int index, bool paddleIsLeft)
+{
+    const PongConfig *rules = PONG_CONFIG(batch->config);
+    Paddle paddle =
+    {
+        .position = { GetPongBatchPaddleX(rules, paddleIsLeft), paddleIsLeft ? batch->paddleLY[index] : batch->paddleRY[index] },
+        .nextHitPos = paddleIsLeft ? batch->nextHitPosL[index] : batch->nextHitPosR[index],
+        .ai = batch->ai,
+        .predictionId = paddleIsLeft ? batch->predictionIdL[index] : batch->predictionIdR[index],
+        .targetY = paddleIsLeft ? batch->targetYL[index] : batch->targetYR[index],
+        .nextTargetY = paddleIsLeft ? batch->nextTargetYL[index] : batch->nextTargetYR[index],
+        .reactionTimer = paddleIsLeft ? batch->reactionTimerL[index] : batch->reactionTimerR[index],
+        .speed = paddleIsLeft ? batch->paddleLSpeed[index] : batch->paddleRSpeed[index],
+        .length = rules->paddleLength,
+        .width = rules->paddleWidth,
+    };
+    return paddle;
+}
+
+static void StorePongBatchPaddle(PongBatch *batch, int index, bool paddleIsLeft, const Paddle *paddle)
+{
+    if (paddleIsLeft)
+    {
+        batch->paddleLY[index] = paddle->position.y;
+        batch->paddleLSpeed[index] = paddle->speed;
+        batch->nextHitPosL[index] = paddle->nextHitPos;
+        batch->predictionIdL[index] = paddle->predictionId;
+        batch->targetYL[index] = paddle->targetY;
+        batch->nextTargetYL[index] = paddle->nextTargetY;
+        batch->reactionTimerL[index] = paddle->reactionTimer;
+    }
+    else
+    {
+        batch->paddleRY[index] = paddle->position.y;
+        batch->paddleRSpeed[index] = paddle->speed;
+        batch->nextHitPosR[index] = paddle->nextHitPos;
+        batch->predictionIdR[index] = paddle->predictionId;
+        batch->targetYR[index] = paddle->targetY;
+        batch->nextTargetYR[index] = paddle->nextTargetY;
+        batch->reactionTimerR[index] = paddle->reactionTimer;
+    }
+}
+
+static void UpdatePongBatchPaddles(PongBatch *batch, float deltaTime)
+{
+    // Left first, same as MODE_DEMO in StepPong(), since both computers draw from the match's random numbers
+    for (int side = 0; side < 2; side++)
+    {
+        bool paddleIsLeft = (side == 0);
+        if (paddleIsLeft ? batch->computerL : batch->computerR)
+        {
+            for (int i = 0; i < batch->count; i++)
+            {
+                Ball ball = LoadPongBatchBall(batch, i);
+                Paddle paddle = LoadPongBatchPaddle(batch, i, paddleIsLeft);
+                UpdatePaddleComputer(&paddle, &ball, &batch->rng[i], batch->config, deltaTime);
+                StorePongBatchPaddle(batch, i, paddleIsLeft, &paddle);
+            }
+        }
+        else
+        {
+            // Same as UpdatePaddlePlayer(), with the speed already set
+            float *paddleY = paddleIsLeft ? batch->paddleLY : batch->paddleRY;
+            const float *paddleSpeed = paddleIsLeft ? batch->paddleLSpeed : batch->paddleRSpeed;
+            for (int i = 0; i < batch->count; i++)
+                paddleY[i] += paddleSpeed[i] * deltaTime;
+        }
+    }
+}
+
+static void StepPongBatchMatch(PongBatch *batch, int index, float deltaTime)
+{
+    const PongConfig *rules = PONG_CONFIG(batch->config);
+    GameState pong =
+    {
+        .currentScreen = SCREEN_GAMEPLAY,
+        .config = batch->config,
+        .rng = batch->rng[index],
+        .ball = LoadPongBatchBall(batch, index),
+        .paddleL = LoadPongBatchPaddle(batch, index, true),
+        .paddleR = LoadPongBatchPaddle(batch, index, false),
+        .currentMode = MODE_DEMO,
+        .scoreL = batch->scoreL[index],
+        .scoreR = batch->scoreR[index],
+        .scoreTimer = batch->scoreTimer[index],
+    };
+
+    // Same order as StepPong(), a match never sits on the win screen here
+    BounceBallPaddle(&pong.ball, &pong.paddleL, &pong.rng, NULL, batch->config);
+    BounceBallPaddle(&pong.ball, &pong.paddleR, &pong.rng, NULL, batch->config);
+    if (pong.scoreTimer <= 0)
+        MoveBall(&pong, deltaTime);
+    BounceBallPaddle(&pong.ball, &pong.paddleL, &pong.rng, NULL, batch->config);
+    BounceBallPaddle(&pong.ball, &pong.paddleR, &pong.rng, NULL, batch->config);
+    EdgeCollisionPaddle(&pong.paddleL);
+    EdgeCollisionPaddle(&pong.paddleR);
+    if (pong.scoreTimer > 0)
+        pong.scoreTimer -= deltaTime;
+
+    batch->ballX[index] = pong.ball.position.x;
+    batch->ballY[index] = pong.ball.position.y;
+    batch->ballDirX[index] = pong.ball.direction.x;
+    batch->ballDirY[index] = pong.ball.direction.y;
+    batch->ballSpeed[index] = pong.ball.speed;
+    batch->paddleHits[index] = pong.ball.paddleHits;
+    batch->trajectoryId[index] = pong.ball.trajectoryId;
+    StorePongBatchPaddle(batch, index, true, &pong.paddleL);
+    StorePongBatchPaddle(batch, index, false, &pong.paddleR);
+    batch->scoreTimer[index] = pong.scoreTimer;
+    batch->scoreL[index] = pong.scoreL;
+    batch->scoreR[index] = pong.scoreR;
+    batch->rng[index] = pong.rng;
+
+    // There's no win screen here, the next match starts right away
+    // like skipping it in StepPong()
+    if (pong.scoreL >= rules->winScore)
+    {
+        batch->winsL[index]++;
+        ResetPongBatchMatch(batch, index);
+    }
+    else if (pong.scoreR >= rules->winScore)
+    {
+        batch->winsR[index]++;
+        ResetPongBatchMatch(batch, index);
+    }
+}
+
+// Scalar kernel, used when no SIMD path is available and as the reference for the others
+static void StepPongBatchScalar(PongBatch *batch, float deltaTime)
+{
+    for (int i = 0; i < batch->count; i++)
+        StepPongBatchMatch(batch, i, deltaTime);
+}
+
+#if defined(BATCH_SIMD_SSE2)
+// SSE2 kernel, 4 matches per instruction
+// Balls in open play move here, with the same operations as GetBallVelocity() so the results
+// are identical. Anything within BATCH_SWEEP_MARGIN of an edge or a paddle this step (or still
+// in the score pause next to one) is handed to the scalar code, which sweeps it properly
+static void StepPongBatchSse2(PongBatch *batch, float deltaTime)
+{
+    const PongConfig *rules = PONG_CONFIG(batch->config);
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 signBit = _mm_set1_ps(-0.0f);
+    const __m128 dt = _mm_set1_ps(deltaTime);
+    const __m128 margin = _mm_set1_ps(BATCH_SWEEP_MARGIN);
+    const __m128 minSin = _mm_set1_ps(rules->minimumVerticalSin);
+    const __m128 ballSize = _mm_set1_ps((float)rules->ballSize);
+    const __m128 paddleLength = _mm_set1_ps((float)rules->paddleLength);
+    const __m128 paddleLX = _mm_set1_ps(GetPongBatchPaddleX(rules, true));
+    const __m128 paddleRX = _mm_set1_ps(GetPongBatchPaddleX(rules, false));
+    const __m128 paddleLXEnd = _mm_set1_ps(GetPongBatchPaddleX(rules, true) + rules->paddleWidth);
+    const __m128 paddleRXEnd = _mm_set1_ps(GetPongBatchPaddleX(rules, false) + rules->paddleWidth);
+    const __m128 fieldTop = _mm_set1_ps(FIELD_LINE_WIDTH);
+    const __m128 fieldBottom = _mm_set1_ps(RENDER_HEIGHT - FIELD_LINE_WIDTH);
+    const __m128 fieldRight = _mm_set1_ps(RENDER_WIDTH);
+    const __m128 paddleMaxY = _mm_set1_ps((float)(RENDER_HEIGHT - FIELD_LINE_WIDTH - rules->paddleLength));
+
+    for (int i = 0; i < batch->count; i += 4)
+    {
+        // Velocity, same as GetBallVelocity()
+        __m128 dirX = _mm_load_ps(&batch->ballDirX[i]);
+        __m128 dirY = _mm_load_ps(&batch->ballDirY[i]);
+        __m128 length = _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(dirX, dirX), _mm_mul_ps(dirY, dirY)));
+        __m128 minX = _mm_mul_ps(length, minSin);
+        __m128 tooFlat = _mm_cmplt_ps(_mm_andnot_ps(signBit, dirX), minX);
+        __m128 clampedX = BATCH_SELECT_SSE2(_mm_cmpge_ps(dirX, zero), minX, _mm_xor_ps(minX, signBit));
+        __m128 clampedY = _mm_sqrt_ps(_mm_sub_ps(_mm_mul_ps(length, length), _mm_mul_ps(clampedX, clampedX)));
+        clampedY = BATCH_SELECT_SSE2(_mm_cmpge_ps(dirY, zero), clampedY, _mm_xor_ps(clampedY, signBit));
+        __m128 velocityX = BATCH_SELECT_SSE2(tooFlat, clampedX, dirX);
+        __m128 velocityY = BATCH_SELECT_SSE2(tooFlat, clampedY, dirY);
+        __m128 normal = _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(velocityX, velocityX), _mm_mul_ps(velocityY, velocityY)));
+        __m128 inverse = _mm_div_ps(one, normal);
+        __m128 speed = _mm_load_ps(&batch->ballSpeed[i]);
+        __m128 hasLength = _mm_cmpgt_ps(normal, zero);
+        velocityX = _mm_and_ps(hasLength, _mm_mul_ps(_mm_mul_ps(velocityX, inverse), speed));
+        velocityY = _mm_and_ps(hasLength, _mm_mul_ps(_mm_mul_ps(velocityY, inverse), speed));
+
+        // Move the ball, only where the score timer ran out
+        __m128 timer = _mm_load_ps(&batch->scoreTimer[i]);
+        __m128 moving = _mm_cmple_ps(timer, zero);
+        __m128 ballX = _mm_load_ps(&batch->ballX[i]);
+        __m128 ballY = _mm_load_ps(&batch->ballY[i]);
+        __m128 endX = BATCH_SELECT_SSE2(moving, _mm_add_ps(ballX, _mm_mul_ps(velocityX, dt)), ballX);
+        __m128 endY = BATCH_SELECT_SSE2(moving, _mm_add_ps(ballY, _mm_mul_ps(velocityY, dt)), ballY);
+
+        // Box around the whole path, so anything the sweep or the overlap tests could find is inside it
+        __m128 lowX = _mm_sub_ps(_mm_min_ps(ballX, endX), margin);
+        __m128 lowY = _mm_sub_ps(_mm_min_ps(ballY, endY), margin);
+        __m128 highX = _mm_add_ps(_mm_add_ps(_mm_max_ps(ballX, endX), ballSize), margin);
+        __m128 highY = _mm_add_ps(_mm_add_ps(_mm_max_ps(ballY, endY), ballSize), margin);
+        __m128 paddleLY = _mm_load_ps(&batch->paddleLY[i]);
+        __m128 paddleRY = _mm_load_ps(&batch->paddleRY[i]);
+        __m128 edge = _mm_or_ps(_mm_or_ps(_mm_cmple_ps(lowX, zero), _mm_cmpge_ps(highX, fieldRight)),
+                                _mm_or_ps(_mm_cmple_ps(lowY, fieldTop), _mm_cmpge_ps(highY, fieldBottom)));
+        __m128 nearL = _mm_and_ps(_mm_and_ps(_mm_cmple_ps(lowX, paddleLXEnd), _mm_cmpge_ps(highX, paddleLX)),
+                                  _mm_and_ps(_mm_cmple_ps(lowY, _mm_add_ps(paddleLY, paddleLength)), _mm_cmpge_ps(highY, paddleLY)));
+        __m128 nearR = _mm_and_ps(_mm_and_ps(_mm_cmple_ps(lowX, paddleRXEnd), _mm_cmpge_ps(highX, paddleRX)),
+                                  _mm_and_ps(_mm_cmple_ps(lowY, _mm_add_ps(paddleRY, paddleLength)), _mm_cmpge_ps(highY, paddleRY)));
+        __m128 scalar = _mm_or_ps(edge, _mm_or_ps(nearL, nearR));
+
+        // Paddles collide with screen edges, same as EdgeCollisionPaddle()
+        __m128 clampedLY = BATCH_SELECT_SSE2(_mm_cmple_ps(paddleLY, fieldTop), fieldTop, paddleLY);
+        __m128 clampedRY = BATCH_SELECT_SSE2(_mm_cmple_ps(paddleRY, fieldTop), fieldTop, paddleRY);
+        clampedLY = BATCH_SELECT_SSE2(_mm_cmpgt_ps(_mm_add_ps(clampedLY, paddleLength), fieldBottom), paddleMaxY, clampedLY);
+        clampedRY = BATCH_SELECT_SSE2(_mm_cmpgt_ps(_mm_add_ps(clampedRY, paddleLength), fieldBottom), paddleMaxY, clampedRY);
+        __m128 newTimer = BATCH_SELECT_SSE2(_mm_cmpgt_ps(timer, zero), _mm_sub_ps(timer, dt), timer);
+
+        // Only keep the lanes that don't need the scalar code, it starts from the old values
+        _mm_store_ps(&batch->ballDirX[i], BATCH_SELECT_SSE2(scalar, dirX, BATCH_SELECT_SSE2(moving, velocityX, dirX)));
+        _mm_store_ps(&batch->ballDirY[i], BATCH_SELECT_SSE2(scalar, dirY, BATCH_SELECT_SSE2(moving, velocityY, dirY)));
+        _mm_store_ps(&batch->ballX[i], BATCH_SELECT_SSE2(scalar, ballX, endX));
+        _mm_store_ps(&batch->ballY[i], BATCH_SELECT_SSE2(scalar, ballY, endY));
+        _mm_store_ps(&batch->paddleLY[i], BATCH_SELECT_SSE2(scalar, paddleLY, clampedLY));
+        _mm_store_ps(&batch->paddleRY[i], BATCH_SELECT_SSE2(scalar, paddleRY, clampedRY));
+        _mm_store_ps(&batch->scoreTimer[i], BATCH_SELECT_SSE2(scalar, timer, newTimer));
+
+        int lanes = _mm_movemask_ps(scalar);
+        for (int lane = 0; lanes != 0 && lane < 4; lane++)
+        {
+            if ((lanes & (1 << lane)) && (i + lane < batch->count))
+                StepPongBatchMatch(batch, i + lane, deltaTime);
+        }
+    }
+}
+#endif // BATCH_SIMD_SSE2
+
+#if defined(BATCH_SIMD_AVX2)
+// AVX2 kernel, 8 matches per instruction, otherwise the same as the SSE2 kernel
+BATCH_TARGET_AVX2 static void StepPongBatchAvx2(PongBatch *batch, float deltaTime)
+{
+    const PongConfig *rules = PONG_CONFIG(batch->config);
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 one = _mm256_set1_ps(1.0f);
+    const __m256 signBit = _mm256_set1_ps(-0.0f);
+    const __m256 dt = _mm256_set1_ps(deltaTime);
+    const __m256 margin = _mm256_set1_ps(BATCH_SWEEP_MARGIN);
+    const __m256 minSin = _mm256_set1_ps(rules->minimumVerticalSin);
+    const __m256 ballSize = _mm256_set1_ps((float)rules->ballSize);
+    const __m256 paddleLength = _mm256_set1_ps((float)rules->paddleLength);
+    const __m256 paddleLX = _mm256_set1_ps(GetPongBatchPaddleX(rules, true));
+    const __m256 paddleRX = _mm256_set1_ps(GetPongBatchPaddleX(rules, false));
+    const __m256 paddleLXEnd = _mm256_set1_ps(GetPongBatchPaddleX(rules, true) + rules->paddleWidth);
+    const __m256 paddleRXEnd = _mm256_set1_ps(GetPongBatchPaddleX(rules, false) + rules->paddleWidth);
+    const __m256 fieldTop = _mm256_set1_ps(FIELD_LINE_WIDTH);
+    const __m256 fieldBottom = _mm256_set1_ps(RENDER_HEIGHT - FIELD_LINE_WIDTH);
+    const __m256 fieldRight = _mm256_set1_ps(RENDER_WIDTH);
+    const __m256 paddleMaxY = _mm256_set1_ps((float)(RENDER_HEIGHT - FIELD_LINE_WIDTH - rules->paddleLength));
+
+    for (int i = 0; i < batch->count; i += 8)
+    {
+        // Velocity, same as GetBallVelocity()
+        __m256 dirX = _mm256_load_ps(&batch->ballDirX[i]);
+        __m256 dirY = _mm256_load_ps(&batch->ballDirY[i]);
+        __m256 length = _mm256_sqrt_ps(_mm256_add_ps(_mm256_mul_ps(dirX, dirX), _mm256_mul_ps(dirY, dirY)));
+        __m256 minX = _mm256_mul_ps(length, minSin);
+        __m256 tooFlat = _mm256_cmp_ps(_mm256_andnot_ps(signBit, dirX), minX, _CMP_LT_OQ);
+        __m256 clampedX = _mm256_blendv_ps(_mm256_xor_ps(minX, signBit), minX, _mm256_cmp_ps(dirX, zero, _CMP_GE_OQ));
+        __m256 clampedY = _mm256_sqrt_ps(_mm256_sub_ps(_mm256_mul_ps(length, length), _mm256_mul_ps(clampedX, clampedX)));
+        clampedY = _mm256_blendv_ps(_mm256_xor_ps(clampedY, signBit), clampedY, _mm256_cmp_ps(dirY, zero, _CMP_GE_OQ));
+        __m256 velocityX = _mm256_blendv_ps(dirX, clampedX, tooFlat);
+        __m256 velocityY = _mm256_blendv_ps(dirY, clampedY, tooFlat);
+        __m256 normal = _mm256_sqrt_ps(_mm256_add_ps(_mm256_mul_ps(velocityX, velocityX), _mm256_mul_ps(velocityY, velocityY)));
+        __m256 inverse = _mm256_div_ps(one, normal);
+        __m256 speed = _mm256_load_ps(&batch->ballSpeed[i]);
+        __m256 hasLength = _mm256_cmp_ps(normal, zero, _CMP_GT_OQ);
+        velocityX = _mm256_and_ps(hasLength, _mm256_mul_ps(_mm256_mul_ps(velocityX, inverse), speed));
+        velocityY = _mm256_and_ps(hasLength, _mm256_mul_ps(_mm256_mul_ps(velocityY, inverse), speed));
+
+        // Move the ball, only where the score timer ran out
+        __m256 timer = _mm256_load_ps(&batch->scoreTimer[i]);
+        __m256 moving = _mm256_cmp_ps(timer, zero, _CMP_LE_OQ);
+        __m256 ballX = _mm256_load_ps(&batch->ballX[i]);
+        __m256 ballY = _mm256_load_ps(&batch->ballY[i]);
+        __m256 endX = _mm256_blendv_ps(ballX, _mm256_add_ps(ballX, _mm256_mul_ps(velocityX, dt)), moving);
+        __m256 endY = _mm256_blendv_ps(ballY, _mm256_add_ps(ballY, _mm256_mul_ps(velocityY, dt)), moving);
+
+        // Box around the whole path, so anything the sweep or the overlap tests could find is inside it
+        __m256 lowX = _mm256_sub_ps(_mm256_min_ps(ballX, endX), margin);
+        __m256 lowY = _mm256_sub_ps(_mm256_min_ps(ballY, endY), margin);
+        __m256 highX = _mm256_add_ps(_mm256_add_ps(_mm256_max_ps(ballX, endX), ballSize), margin);
+        __m256 highY = _mm256_add_ps(_mm256_add_ps(_mm256_max_ps(ballY, endY), ballSize), margin);
+        __m256 paddleLY = _mm256_load_ps(&batch->paddleLY[i]);
+        __m256 paddleRY = _mm256_load_ps(&batch->paddleRY[i]);
+        __m256 edge = _mm256_or_ps(_mm256_or_ps(_mm256_cmp_ps(lowX, zero, _CMP_LE_OQ), _mm256_cmp_ps(highX, fieldRight, _CMP_GE_OQ)),
+                                   _mm256_or_ps(_mm256_cmp_ps(lowY, fieldTop, _CMP_LE_OQ), _mm256_cmp_ps(highY, fieldBottom, _CMP_GE_OQ)));
+        __m256 nearL = _mm256_and_ps(_mm256_and_ps(_mm256_cmp_ps(lowX, paddleLXEnd, _CMP_LE_OQ), _mm256_cmp_ps(highX, paddleLX, _CMP_GE_OQ)),
+                                     _mm256_and_ps(_mm256_cmp_ps(lowY, _mm256_add_ps(paddleLY, paddleLength), _CMP_LE_OQ),
+                                                   _mm256_cmp_ps(highY, paddleLY, _CMP_GE_OQ)));
+        __m256 nearR = _mm256_and_ps(_mm256_and_ps(_mm256_cmp_ps(lowX, paddleRXEnd, _CMP_LE_OQ), _mm256_cmp_ps(highX, paddleRX, _CMP_GE_OQ)),
+                                     _mm256_and_ps(_mm256_cmp_ps(lowY, _mm256_add_ps(paddleRY, paddleLength), _CMP_LE_OQ),
+                                                   _mm256_cmp_ps(highY, paddleRY, _CMP_GE_OQ)));
+        __m256 scalar = _mm256_or_ps(edge, _mm256_or_ps(nearL, nearR));
+
+        // Paddles collide with screen edges, same as EdgeCollisionPaddle()
+        __m256 clampedLY = _mm256_blendv_ps(paddleLY, fieldTop, _mm256_cmp_ps(paddleLY, fieldTop, _CMP_LE_OQ));
+        __m256 clampedRY = _mm256_blendv_ps(paddleRY, fieldTop, _mm256_cmp_ps(paddleRY, fieldTop, _CMP_LE_OQ));
+        clampedLY = _mm256_blendv_ps(clampedLY, paddleMaxY, _mm256_cmp_ps(_mm256_add_ps(clampedLY, paddleLength), fieldBottom, _CMP_GT_OQ));
+        clampedRY = _mm256_blendv_ps(clampedRY, paddleMaxY, _mm256_cmp_ps(_mm256_add_ps(clampedRY, paddleLength), fieldBottom, _CMP_GT_OQ));
+        __m256 newTimer = _mm256_blendv_ps(timer, _mm256_sub_ps(timer, dt), _mm256_cmp_ps(timer, zero, _CMP_GT_OQ));
+
+        // Only keep the lanes that don't need the scalar code, it starts from the old values
+        _mm256_store_ps(&batch->ballDirX[i], _mm256_blendv_ps(_mm256_blendv_ps(dirX, velocityX, moving), dirX, scalar));
+        _mm256_store_ps(&batch->ballDirY[i], _mm256_blendv_ps(_mm256_blendv_ps(dirY, velocityY, moving), dirY, scalar));
+        _mm256_store_ps(&batch->ballX[i], _mm256_blendv_ps(endX, ballX, scalar));
+        _mm256_store_ps(&batch->ballY[i], _mm256_blendv_ps(endY, ballY, scalar));
+        _mm256_store_ps(&batch->paddleLY[i], _mm256_blendv_ps(clampedLY, paddleLY, scalar));
+        _mm256_store_ps(&batch->paddleRY[i], _mm256_blendv_ps(clampedRY, paddleRY, scalar));
+        _mm256_store_ps(&batch->scoreTimer[i], _mm256_blendv_ps(newTimer, timer, scalar));
+
+        int lanes = _mm256_movemask_ps(scalar);
+        for (int lane = 0; lanes != 0 && lane < 8; lane++)
+        {
+            if ((lanes & (1 << lane)) && (i + lane < batch->count))
+                StepPongBatchMatch(batch, i + lane, deltaTime);
+        }
+    }
+}
+#endif // BATCH_SIMD_AVX2
+
+bool IsPongBatchKernelSupported(BatchKernel kernel)
+{
+    switch (kernel)
+    {
+        case BATCH_KERNEL_SCALAR: return true;
+#if defined(BATCH_SIMD_SSE2)
+        case BATCH_KERNEL_SSE2:   return true;
+#endif
+#if defined(BATCH_SIMD_AVX2)
+        case BATCH_KERNEL_AVX2:   return __builtin_cpu_supports("avx2");
+#endif
+        default: return false;
+    }
+}
+
+BatchKernel GetBestPongBatchKernel(void)
+{
+    if (IsPongBatchKernelSupported(BATCH_KERNEL_AVX2))
+        return BATCH_KERNEL_AVX2;
+    if (IsPongBatchKernelSupported(BATCH_KERNEL_SSE2))
+        return BATCH_KERNEL_SSE2;
+    return BATCH_KERNEL_SCALAR;
+}
+
+const char *GetPongBatchKernelName(BatchKernel kernel)
+{
+    switch (kernel)
+    {
+        case BATCH_KERNEL_SCALAR: return "scalar";
+        case BATCH_KERNEL_SSE2:   return "sse2";
+        case BATCH_KERNEL_AVX2:   return "avx2";
+        default: return "unknown";
+    }
+}
+
+void StepPongBatch(PongBatch *batch, float deltaTime)
+{
+    UpdatePongBatchPaddles(batch, deltaTime);
+
+    switch (batch->kernel)
+    {
+#if defined(BATCH_SIMD_AVX2)
+        case BATCH_KERNEL_AVX2: StepPongBatchAvx2(batch, deltaTime);
+                                break;
+#endif
+#if defined(BATCH_SIMD_SSE2)
+        case BATCH_KERNEL_SSE2: StepPongBatchSse2(batch, deltaTime);
+                                break;
+#endif
+        default: StepPongBatchScalar(batch, deltaTime);
+                 break;
+    }
+}
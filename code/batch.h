@@ -0,0 +1,83 @@
+// EXPLANATION:
+// Runs many headless matches at once, for AI tuning and other bulk simulation
+// Every match plays exactly like a StepPong() game in pong.c that skips the win
+// screen: match i is InitGameState(seed + i), and after a win the next match is
+// seeded from the last one like StepPong() does. The data is stored as a structure
+// of arrays so one pass can step all of them together, and anything that touches an
+// edge or a paddle goes through the same functions as StepPong() (MoveBall(),
+// BounceBallPaddle(), UpdatePaddleComputer() and so on)
+
+#ifndef PONG_BATCH_HEADER_GUARD
+#define PONG_BATCH_HEADER_GUARD
+
+#include "states.h"
+
+// Macros
+// --------------------------------------------------------------------------------
+#define BATCH_ALIGNMENT 32 // Byte alignment of every array, wide enough for 8 floats
+
+// Types and Structures
+// --------------------------------------------------------------------------------
+typedef enum BatchKernel // Instruction set used to step the matches
+{
+    BATCH_KERNEL_SCALAR, BATCH_KERNEL_SSE2, BATCH_KERNEL_AVX2
+} BatchKernel;
+
+typedef struct PongBatch // One entry in each array per match
+{
+    int count; // Number of matches
+    int capacity; // Arrays are padded up to this length
+    BatchKernel kernel; // Defaults to the fastest supported one
+    const PongConfig *config; // Rules for every match, never NULL, owned by whoever made the batch
+    bool computerL; // Moved by the computer like MODE_DEMO, otherwise by paddleLSpeed
+    bool computerR;
+    ComputerAi ai; // Tuning for both computer paddles, see SetPongBatchDifficulty()
+
+    // Ball
+    float *ballX;
+    float *ballY;
+    float *ballDirX;
+    float *ballDirY;
+    float *ballSpeed;
+    int *paddleHits; // Total this match, same as Ball.paddleHits
+    unsigned int *trajectoryId;
+
+    // Paddles (position is the top edge)
+    float *paddleLY;
+    float *paddleRY;
+    float *paddleLSpeed; // Pixels per second, set by the caller before each step unless the computer moves it
+    float *paddleRSpeed;
+    float *nextHitPosL; // The rest are only used by computer paddles, same as in Paddle
+    float *nextHitPosR;
+    unsigned int *predictionIdL;
+    unsigned int *predictionIdR;
+    float *targetYL;
+    float *targetYR;
+    float *nextTargetYL;
+    float *nextTargetYR;
+    float *reactionTimerL;
+    float *reactionTimerR;
+
+    // Match progress
+    float *scoreTimer;
+    int *scoreL;
+    int *scoreR;
+    unsigned int *winsL; // Completed matches won by each side
+    unsigned int *winsR;
+    PongRng *rng; // Each match's random numbers, so results don't depend on the kernel or thread
+
+    void *memory; // Single allocation backing all the arrays
+} PongBatch;
+
+// Prototypes
+// --------------------------------------------------------------------------------
+PongBatch InitPongBatch(int count, unsigned int seed, const PongConfig *config); // Allocates the arrays and starts every match, both paddles on the computer, config NULL for the defaults
+void FreePongBatch(PongBatch *batch);
+void ResetPongBatchMatch(PongBatch *batch, int index); // Starts the next match in one slot, keeping its win counts
+void SetPongBatchDifficulty(PongBatch *batch, GameDifficulty difficulty); // Retunes both computer paddles, like SetGameDifficulty()
+void StepPongBatch(PongBatch *batch, float deltaTime); // Advances every match by one step, same as StepPong()
+bool IsPongBatchKernelSupported(BatchKernel kernel); // Checks both the build and the running CPU
+BatchKernel GetBestPongBatchKernel(void);
+const char *GetPongBatchKernelName(BatchKernel kernel);
+
+#endif // PONG_BATCH_HEADER_GUARD
@@ -17,10 +17,12 @@
 #define DEFAULT_HEIGHT 720 // Default size of the game window
 #define DEFAULT_WIDTH (int)(DEFAULT_HEIGHT * ASPECT_RATIO)
 
-// there may be small bugs with very high FPS (uncapped + no vsync), but should work fine overall
+// game logic runs at a fixed rate (see SIM_TICK_RATE in pong.h), so any framerate plays the same
 #define MAX_FRAMERATE 120 // Set to 0 for uncapped framerate
 #define VSYNC_ENABLED true
 
+#define REWIND_SECONDS 10 // Gameplay kept for rewinding with R, change with --rewind-seconds (0 turns it off)
+
 #define MAX(a, b) ((a)>(b)? (a) : (b)) // Used to calculate framebuffer scaling
 #define MIN(a, b) ((a)<(b)? (a) : (b))
 
@@ -0,0 +1,134 @@
+// EXPLANATION:
+// Reinforcement learning environments for training paddles, built on PongBatch
+// See env.h for more documentation/descriptions
+
+#include "env.h"
+
+#include <math.h>
+#include <stddef.h> // for size_t
+#include "raylib.h"
+#include "raymath.h" // for Clamp()
+
+#include "config.h"
+#include "pong.h" // for PONG_CONFIG()
+
+// Local Functions Declaration
+// --------------------------------------------------------------------------------
+static void WritePongEnvObservations(PongEnv *env);
+
+PongEnv InitPongEnv(int count, unsigned int seed, bool computerOpponent, GameDifficulty difficulty, const PongConfig *config)
+{
+    PongEnv env = { 0 };
+    env.batch = InitPongBatch(count, seed, config);
+    env.batch.computerL = false; // the agent's
+    env.batch.computerR = computerOpponent;
+    SetPongBatchDifficulty(&env.batch, difficulty);
+    env.computerOpponent = computerOpponent;
+    env.difficulty = difficulty;
+    env.maxSpeed = env.batch.ai.speed;
+
+    // Largest elements first, so everything stays aligned
+    size_t observationSize = (size_t)count * OBS_COUNT * sizeof(float);
+    size_t arraySize = (size_t)count * sizeof(float);
+    env.memory = MemAlloc((unsigned int)(observationSize + arraySize * 5 + (size_t)count * sizeof(bool)));
+    char *next = env.memory;
+
+    env.observations = (float *)next;        next += observationSize;
+    env.rewards      = (float *)next;        next += arraySize;
+    env.lastScoreL   = (int *)next;          next += arraySize;
+    env.lastScoreR   = (int *)next;          next += arraySize;
+    env.lastWinsL    = (unsigned int *)next; next += arraySize;
+    env.lastWinsR    = (unsigned int *)next; next += arraySize;
+    env.dones        = (bool *)next;
+
+    ResetPongEnv(&env);
+    return env;
+}
+
+void FreePongEnv(PongEnv *env)
+{
+    FreePongBatch(&env->batch);
+    MemFree(env->memory);
+    *env = (PongEnv){ 0 };
+}
+
+void ResetPongEnv(PongEnv *env)
+{
+    PongBatch *batch = &env->batch;
+    for (int i = 0; i < batch->count; i++)
+    {
+        ResetPongBatchMatch(batch, i);
+        env->lastScoreL[i] = 0;
+        env->lastScoreR[i] = 0;
+        env->lastWinsL[i] = batch->winsL[i];
+        env->lastWinsR[i] = batch->winsR[i];
+        env->rewards[i] = 0.0f;
+        env->dones[i] = false;
+    }
+
+    WritePongEnvObservations(env);
+}
+
+void StepPongEnv(PongEnv *env, const float *actions)
+{
+    PongBatch *batch = &env->batch;
+
+    // The batch moves the computer's paddle itself
+    int actionCount = GetPongEnvActionCount(env);
+    for (int i = 0; i < batch->count; i++)
+    {
+        const float *action = &actions[i * actionCount];
+        batch->paddleLSpeed[i] = Clamp(action[0], -1.0f, 1.0f) * env->maxSpeed;
+        if (!env->computerOpponent)
+            batch->paddleRSpeed[i] = Clamp(action[1], -1.0f, 1.0f) * env->maxSpeed;
+    }
+
+    StepPongBatch(batch, SIM_TIMESTEP);
+
+    // The batch resets both scores when a match is won, so the winning point shows up in the wins
+    for (int i = 0; i < batch->count; i++)
+    {
+        bool wonL = batch->winsL[i] != env->lastWinsL[i];
+        bool wonR = batch->winsR[i] != env->lastWinsR[i];
+        if (wonL || wonR)
+            env->rewards[i] = wonL ? 1.0f : -1.0f;
+        else
+            env->rewards[i] = (float)((batch->scoreL[i] - env->lastScoreL[i]) - (batch->scoreR[i] - env->lastScoreR[i]));
+        env->dones[i] = wonL || wonR;
+
+        env->lastScoreL[i] = batch->scoreL[i];
+        env->lastScoreR[i] = batch->scoreR[i];
+        env->lastWinsL[i] = batch->winsL[i];
+        env->lastWinsR[i] = batch->winsR[i];
+    }
+
+    WritePongEnvObservations(env);
+}
+
+int GetPongEnvActionCount(const PongEnv *env)
+{
+    return env->computerOpponent ? 1 : 2;
+}
+
+static void WritePongEnvObservations(PongEnv *env)
+{
+    const PongBatch *batch = &env->batch;
+    float scorePauseTime = PONG_CONFIG(batch->config)->scorePauseTime;
+    for (int i = 0; i < batch->count; i++)
+    {
+        // The direction is only scaled to the ball's speed once it moves, so do it here
+        float dirX = batch->ballDirX[i];
+        float dirY = batch->ballDirY[i];
+        float length = sqrtf(dirX*dirX + dirY*dirY);
+        float scale = (length > 0.0f) ? batch->ballSpeed[i] / length : 0.0f;
+
+        float *observation = &env->observations[i * OBS_COUNT];
+        observation[OBS_BALL_X] = batch->ballX[i] / RENDER_WIDTH;
+        observation[OBS_BALL_Y] = batch->ballY[i] / RENDER_HEIGHT;
+        observation[OBS_BALL_SPEED_X] = dirX * scale / RENDER_WIDTH;
+        observation[OBS_BALL_SPEED_Y] = dirY * scale / RENDER_HEIGHT;
+        observation[OBS_PADDLE_L_Y] = batch->paddleLY[i] / RENDER_HEIGHT;
+        observation[OBS_PADDLE_R_Y] = batch->paddleRY[i] / RENDER_HEIGHT;
+        observation[OBS_SERVE_TIMER] = (scorePauseTime > 0.0f) ? fmaxf(batch->scoreTimer[i], 0.0f) / scorePauseTime : 0.0f;
+    }
+}
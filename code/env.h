@@ -0,0 +1,58 @@
+// EXPLANATION:
+// Reinforcement learning environments for training paddles, built on PongBatch
+// Every call steps all the environments at once and never allocates, and the
+// observations, rewards and done flags are written to arrays owned by the PongEnv
+//
+// The agent always plays the left paddle, and the right one is either the
+// batch's computer paddle or a second agent (two actions per environment)
+// An episode is one match. A finished match starts the next one right away, so
+// the observation after a done flag is already from the new match
+
+#ifndef PONG_ENV_HEADER_GUARD
+#define PONG_ENV_HEADER_GUARD
+
+#include "batch.h"
+
+// Types and Structures
+// --------------------------------------------------------------------------------
+typedef enum PongEnvObservation // Index into each environment's observation, all roughly -1 to 1
+{
+    OBS_BALL_X,       // Left edge of the ball, over RENDER_WIDTH
+    OBS_BALL_Y,       // Top edge of the ball, over RENDER_HEIGHT
+    OBS_BALL_SPEED_X, // Pixels per second over RENDER_WIDTH
+    OBS_BALL_SPEED_Y, // Pixels per second over RENDER_HEIGHT
+    OBS_PADDLE_L_Y,   // Top edge of each paddle, over RENDER_HEIGHT
+    OBS_PADDLE_R_Y,
+    OBS_SERVE_TIMER,  // Time until the ball moves, over the config's scorePauseTime, 0 in play
+    OBS_COUNT
+} PongEnvObservation;
+
+typedef struct PongEnv
+{
+    PongBatch batch;
+    bool computerOpponent; // Otherwise the right paddle takes a second action
+    GameDifficulty difficulty; // Of the computer opponent
+    float maxSpeed; // Paddle speed for an action of 1, same as the computer's top speed
+
+    // Outputs, one entry per environment (observations has OBS_COUNT)
+    float *observations;
+    float *rewards; // Left side's view: +1 when it scores, -1 when it's scored on
+    bool *dones; // A match ended on this step
+
+    // Scores after the last step, for rewards
+    int *lastScoreL;
+    int *lastScoreR;
+    unsigned int *lastWinsL;
+    unsigned int *lastWinsR;
+    void *memory; // Single allocation backing the arrays above
+} PongEnv;
+
+// Prototypes
+// --------------------------------------------------------------------------------
+PongEnv InitPongEnv(int count, unsigned int seed, bool computerOpponent, GameDifficulty difficulty, const PongConfig *config); // config NULL for the defaults, kept in the batch
+void FreePongEnv(PongEnv *env);
+void ResetPongEnv(PongEnv *env); // Starts a new match everywhere and writes the first observations
+void StepPongEnv(PongEnv *env, const float *actions); // Actions are -1 (up) to 1 (down), 1 or 2 per environment
+int GetPongEnvActionCount(const PongEnv *env); // Actions StepPongEnv() reads per environment
+
+#endif // PONG_ENV_HEADER_GUARD
@@ -10,6 +10,16 @@
 #include "logo.h"    // Raylib logo animation
 #include "ui.h"      // User interface (menus and buttons)
 #include "pong.h"    // Game logic
+#include "replay.h"  // Input recording and playback
+#include "netplay.h" // Online two player games
+#include "rewind.h"  // Scrubbing back through a match
+#include "rng.h"     // Random numbers for each game
+#include "profiler.h" // Frame time zones and overlay
+#include "audio.h"   // Beeps, mixed on the audio thread
+
+#include <stdlib.h> // for atoi() and atof()
+#include <string.h> // for strcmp()
+#include <time.h>   // for time(), to seed the game
 
 #if defined(PLATFORM_WEB) // for compiling to wasm (web assembly)
     #include <emscripten/emscripten.h>
@@ -20,38 +30,98 @@
 typedef struct AppData // Local variables for the game loop in main()
 {
     RenderTexture2D renderTarget; // used to hold the rendering result to rescale window
+    Playfield playfield; // field lines, drawn once
     Logo raylibLogo; // data for logo animation
     bool skipCurrentFrame;
+    bool waitingForEvents; // idle on the title screen, so frames only run on input
+    float simAccumulator; // unsimulated time carried over to the next frame
+    PongInput input; // player input for the fixed simulation steps
+    PongReplay replay; // recording or playing back the current game
+    PongNetplay netplay; // playing the current game online
+    PongRewind rewind; // last few seconds of the current game
+    float rewindSeconds; // how much InitRewind() keeps, set before startup gets to it
+    const char *recordFileName; // record the next game started from the title screen
     GameState pong;
+    PongAudio audio; // every game shares the mixer, beeps are made on the audio thread as they play
     UiState ui; // data for main menu
+    Profiler profiler; // frame times, shown with F3
+    StartupTrace startupTrace; // init step times, logged as they happen
+    int startupStep; // next of startupSteps to run
 } AppData;
 
+typedef struct StartupStep
+{
+    const char *name; // for the startup trace
+    void (*run)(AppData *app);
+    bool canWait; // done during the logo, one a frame, instead of before the first frame
+} StartupStep;
+
 // Local Functions Declaration
 // --------------------------------------------------------------------------------
 void CreateNewWindow(void); // Creates a new window with the proper initial settings
-AppData InitGameLoop(void); // Initializes data for the game loop
+AppData InitGameLoop(void); // Initializes what the first frame needs, the rest waits for UpdateStartup()
+void UpdateStartup(AppData *app); // Runs the startup steps left, one a frame during the logo and all at once after it
+void RunStartupStep(AppData *app); // Runs and traces the next step
+void HandleArguments(AppData *app, int argc, char **argv); // --record <file>, --replay <file>, --rewind-seconds <s> and --netplay (see README)
 void CloseGameLoop(AppData *app); // Frees allocated data for the game loop
 void RunGameLoop(AppData *app); // Runs the game loop
+int TakeFixedSteps(float *accumulator, float frameTime); // How many fixed simulation steps fit in the elapsed time
 void UpdateDrawFrame(AppData *app); // Update and Draw the current frame
                                     // Most of the game loop's code is found in here
 void HandleToggleFullscreen(AppData *app);
+void UpdateEventWaiting(AppData *app); // Sleeps between frames while nothing on screen can change by itself
+void HandleScreenChange(AppData *app, ScreenState prevScreen); // Starts and stops replays, netplay and rewinding when gameplay starts and ends
+
+// Startup steps, see startupSteps
+void StartRenderTarget(AppData *app);
+void StartRaylibLogo(AppData *app);
+void StartGameState(AppData *app);
+void StartProfiler(AppData *app);
+void StartAudioDevice(AppData *app);
+void StartPongAudio(AppData *app);
+void StartPlayfield(AppData *app);
+void StartUiState(AppData *app);
+void StartRewind(AppData *app);
+
+// Local Variables Definition
+// --------------------------------------------------------------------------------
+// In order. The logo only needs the render target and game state, so the slow
+// ones (opening the audio device most of all) wait until it's on screen
+static const StartupStep startupSteps[] = {
+    { "LoadRenderTexture", StartRenderTarget, false },
+    { "InitRaylibLogo",    StartRaylibLogo,   false },
+    { "InitGameState",     StartGameState,    false }, // the logo and the command line need it
+    { "InitProfiler",      StartProfiler,     false },
+    { "InitAudioDevice",   StartAudioDevice,  true },
+    { "LoadPongAudio",     StartPongAudio,    true },
+    { "LoadPlayfield",     StartPlayfield,    true },
+    { "InitUiState",       StartUiState,      true },
+    { "InitRewind",        StartRewind,       true },
+};
+#define STARTUP_STEP_COUNT (int)(sizeof(startupSteps) / sizeof(startupSteps[0]))
 
 // Main entry point
 // --------------------------------------------------------------------------------
-int main(void)
+int main(int argc, char **argv)
 {
     // Initialization
     // --------------------------------------------------------------------------------
     CreateNewWindow();
-    InitAudioDevice();
     AppData app = InitGameLoop();
+    HandleArguments(&app, argc, argv);
     RunGameLoop(&app);
 
     // De-Initialization
     // --------------------------------------------------------------------------------
-    FreeBeeps(&app.pong);
-    FreeUiElements(&app.ui);
-    CloseAudioDevice();
+    if (app.replay.mode == REPLAY_RECORDING)
+        SaveReplay(&app.replay);
+    FreeReplay(&app.replay);
+    CloseNetplay(&app.netplay);
+    FreeRewind(&app.rewind);
+    UnloadPongAudio(&app.audio);
+    UnloadPlayfield(&app.playfield);
+    if (IsAudioDeviceReady()) // the window can close before startup gets that far
+        CloseAudioDevice();
     CloseWindow();        // Close window and OpenGL context
 
     return 0;
@@ -75,20 +145,44 @@ void CreateNewWindow(void)
 AppData InitGameLoop(void)
 {
     AppData app = { 0 };
-
-    // Initialize the render texture, used to hold the rendering result so we can easily resize it
-    app.renderTarget = LoadRenderTexture(RENDER_WIDTH, RENDER_HEIGHT);
-    SetTextureFilter(app.renderTarget.texture, TEXTURE_FILTER_BILINEAR);  // Texture scale filter to use
-
     app.skipCurrentFrame = false;
-    app.raylibLogo = InitRaylibLogo();
-    app.ui = InitUiState();
-    app.pong = InitGameState();
+    app.simAccumulator = 0.0f;
+    app.rewindSeconds = REWIND_SECONDS;
 
+    while (app.startupStep < STARTUP_STEP_COUNT && !startupSteps[app.startupStep].canWait)
+        RunStartupStep(&app);
 
     return app;
 }
 
+void UpdateStartup(AppData *app)
+{
+    if (app->startupStep == STARTUP_STEP_COUNT)
+        return;
+
+    // The window shows something first, then the logo hides a step a frame
+    // Anywhere else (skipped the logo, or straight into a replay) needs it all now
+    bool onLogo = (app->pong.currentScreen == SCREEN_LOGO);
+    if (onLogo && !app->startupTrace.hasFirstFrame)
+        return;
+
+    do
+        RunStartupStep(app);
+    while (!onLogo && app->startupStep < STARTUP_STEP_COUNT);
+
+    if (app->startupStep == STARTUP_STEP_COUNT)
+        TraceStartupReady(&app->startupTrace);
+}
+
+void RunStartupStep(AppData *app)
+{
+    const StartupStep *step = &startupSteps[app->startupStep];
+    double startTime = GetTime();
+    step->run(app);
+    TraceStartupStep(&app->startupTrace, step->name, startTime);
+    app->startupStep++;
+}
+
 void RunGameLoop(AppData *app)
 {
 #if defined(PLATFORM_WEB)
@@ -108,9 +202,28 @@ void RunGameLoop(AppData *app)
 #endif
 }
 
+int TakeFixedSteps(float *accumulator, float frameTime)
+{
+    int stepCount = 0;
+    *accumulator += frameTime;
+    while (*accumulator >= SIM_TIMESTEP && stepCount < SIM_MAX_STEPS_PER_FRAME)
+    {
+        *accumulator -= SIM_TIMESTEP;
+        stepCount++;
+    }
+
+    // Too far behind, so forget the rest rather than trying to catch up
+    if (stepCount == SIM_MAX_STEPS_PER_FRAME)
+        *accumulator = 0.0f;
+
+    return stepCount;
+}
+
 // Update data and draw elements to the screen for the current frame
 void UpdateDrawFrame(AppData *app)
 {
+    BeginProfileFrame(&app->profiler);
+
     // Update
     // --------------------------------------------------------------------------------
     // Compute required framebuffer scaling
@@ -125,7 +238,7 @@ void UpdateDrawFrame(AppData *app)
     // if (IsKeyPressed(KEY_R))
     // {
     //     app->pong.scoreTimer = SCORE_PAUSE_TIME;
-    //     ResetBall(&app->pong.ball);
+    //     ResetBall(&app->pong.ball, &app->pong.rng, app->pong.config);
     // }
 
 #if !defined(PLATFORM_WEB) // No fullscreen input for web because it's buggy
@@ -140,36 +253,57 @@ void UpdateDrawFrame(AppData *app)
         return;
     }
 
+    BeginProfileZone(&app->profiler, ZONE_UPDATE);
+    UpdateStartup(app);
+    ScreenState prevScreen = app->pong.currentScreen;
     switch(app->pong.currentScreen)
     {
         case SCREEN_LOGO:     UpdateRaylibLogo(&app->raylibLogo, &app->pong);
                               break;
         case SCREEN_TITLE:    UpdateUiFrame(&app->ui, &app->pong);
                               break;
-        case SCREEN_GAMEPLAY: UpdatePongFrame(&app->pong, &app->ui);
+        case SCREEN_GAMEPLAY: UpdatePongFrame(&app->pong, &app->ui, &app->input, &app->replay, &app->netplay, &app->rewind,
+                                              TakeFixedSteps(&app->simAccumulator, GetFrameTime()));
                               break;
 
         default: break;
     }
+    if (app->pong.currentScreen != prevScreen)
+    {
+        UpdateStartup(app); // the new screen is drawn this frame
+        HandleScreenChange(app, prevScreen);
+    }
+    EndProfileZone(&app->profiler, ZONE_UPDATE);
     // --------------------------------------------------------------------------------
 
+    // Only the title menu ever sits still, the logo and gameplay animate every frame
+    bool redrawTarget = (app->pong.currentScreen != SCREEN_TITLE) || app->ui.needsRedraw;
+    UpdateEventWaiting(app);
+
     // Draw
     // --------------------------------------------------------------------------------
-    BeginTextureMode(app->renderTarget); // Draw to the render texture for screen scaling
+    BeginProfileZone(&app->profiler, ZONE_DRAW);
+    if (redrawTarget)
     {
-        ClearBackground(BLACK); // Default background color
-
-        switch(app->pong.currentScreen)
+        BeginTextureMode(app->renderTarget); // Draw to the render texture for screen scaling
         {
-            case SCREEN_LOGO:     DrawRaylibLogo(&app->raylibLogo);
-                                  break;
-            case SCREEN_TITLE:    DrawUiFrame(&app->ui, MENU_TITLE);
-                                  break;
-            case SCREEN_GAMEPLAY: DrawPongFrame(&app->pong, &app->ui);
-                                  break;
-            default: break;
-        }
-    } EndTextureMode();
+            ClearBackground(BLACK); // Default background color
+
+            switch(app->pong.currentScreen)
+            {
+                case SCREEN_LOGO:     DrawRaylibLogo(&app->raylibLogo);
+                                      break;
+                case SCREEN_TITLE:    DrawUiFrame(&app->ui, MENU_TITLE);
+                                      break;
+                case SCREEN_GAMEPLAY: DrawPongFrame(&app->pong, &app->playfield);
+                                      DrawRewindIndicator(&app->rewind);
+                                      break;
+                default: break;
+            }
+        } EndTextureMode();
+        app->ui.needsRedraw = false;
+    }
+    EndProfileZone(&app->profiler, ZONE_DRAW);
 
     BeginDrawing(); // Draw to screen
     {
@@ -178,16 +312,24 @@ void UpdateDrawFrame(AppData *app)
         // DrawRectangle(0, 0, RENDER_WIDTH, RENDER_HEIGHT, BLACK);
 
         // Draw render texture to screen, properly scaled
+        BeginProfileZone(&app->profiler, ZONE_BLIT);
         float destPosX = (GetScreenWidth() - ((float)RENDER_WIDTH*scale))*0.5f;
         float destPosY = (GetScreenHeight() - ((float)RENDER_HEIGHT*scale))*0.5f;
         DrawTexturePro(app->renderTarget.texture,
                        (Rectangle){ 0.0f, 0.0f, (float)app->renderTarget.texture.width, (float)-app->renderTarget.texture.height },
                        (Rectangle){ destPosX, destPosY, (float)RENDER_WIDTH*scale, (float)RENDER_HEIGHT*scale },
                        (Vector2){ 0, 0 }, 0.0f, WHITE);
+        EndProfileZone(&app->profiler, ZONE_BLIT);
+
+        DrawProfilerOverlay(&app->profiler);
 
         // Debug:
         // DrawFPS(0,0);
+
+        BeginProfileZone(&app->profiler, ZONE_PRESENT);
     } EndDrawing();
+    EndProfileZone(&app->profiler, ZONE_PRESENT);
+    TraceStartupFirstFrame(&app->startupTrace);
     // --------------------------------------------------------------------------------
 }
 
@@ -205,3 +347,137 @@ void HandleToggleFullscreen(AppData *app)
     }
 }
 
+void UpdateEventWaiting(AppData *app)
+{
+    // Holding a key auto-scrolls the menu, and the profiler graph should keep moving
+    bool idle = (app->pong.currentScreen == SCREEN_TITLE) && (app->ui.keyHeldTime == 0.0f) &&
+                !app->profiler.showOverlay;
+    if (idle == app->waitingForEvents)
+        return;
+
+    if (idle)
+        EnableEventWaiting();
+    else
+        DisableEventWaiting();
+    app->waitingForEvents = idle;
+}
+
+void HandleScreenChange(AppData *app, ScreenState prevScreen)
+{
+    // Logo frames clear the flag too, so the menu wouldn't get drawn until something changed
+    if (app->pong.currentScreen == SCREEN_TITLE)
+        app->ui.needsRedraw = true;
+
+    // Game started from the title screen
+    if (app->pong.currentScreen == SCREEN_GAMEPLAY && app->recordFileName != NULL)
+    {
+        unsigned int seed = NextPongRng(&app->pong.rng);
+        StartPongMatch(&app->pong, app->pong.currentMode, app->pong.difficulty, seed);
+        app->replay = InitReplayRecording(app->recordFileName, seed, app->pong.currentMode, app->pong.difficulty);
+        app->recordFileName = NULL; // only the first game
+    }
+
+    // Game is over, back to the title screen
+    if (prevScreen == SCREEN_GAMEPLAY)
+    {
+        if (app->replay.mode == REPLAY_RECORDING)
+            SaveReplay(&app->replay);
+        FreeReplay(&app->replay);
+        CloseNetplay(&app->netplay); // leaving the game ends the online session
+        ClearRewind(&app->rewind);
+    }
+}
+
+void HandleArguments(AppData *app, int argc, char **argv)
+{
+    NetplayConditions netplayConditions = { 0 };
+    for (int i = 1; i + 1 < argc; i++)
+    {
+        if (strcmp(argv[i], "--record") == 0)
+        {
+            app->recordFileName = argv[++i];
+        }
+        else if (strcmp(argv[i], "--replay") == 0)
+        {
+            // Skip the logo and menus, straight into the recorded game
+            app->replay = LoadReplay(argv[++i]);
+            if (app->replay.mode == REPLAY_PLAYING)
+                StartPongMatch(&app->pong, app->replay.gameMode, app->replay.difficulty, app->replay.seed);
+            else
+                TraceLog(LOG_WARNING, "REPLAY: [%s] Could not be played", argv[i]);
+        }
+        else if (strcmp(argv[i], "--rewind-seconds") == 0)
+        {
+            app->rewindSeconds = (float)atof(argv[++i]); // InitRewind() is a startup step
+        }
+        else if (strcmp(argv[i], "--netplay") == 0 && i + 4 < argc)
+        {
+            // --netplay <left|right> <local port> <remote host> <remote port>
+            NetplaySide side = (strcmp(argv[i + 1], "right") == 0) ? NETPLAY_RIGHT : NETPLAY_LEFT;
+            unsigned int seed = NextPongRng(&app->pong.rng);
+            app->netplay = InitNetplay(side, (unsigned short)atoi(argv[i + 2]), argv[i + 3], (unsigned short)atoi(argv[i + 4]), seed);
+            if (app->netplay.mode != NETPLAY_OFF)
+                StartPongMatch(&app->pong, MODE_2PLAYER, app->pong.difficulty, seed); // restarted once both sides are up
+            i += 4;
+        }
+        else if (strcmp(argv[i], "--netplay-sim") == 0 && i + 2 < argc)
+        {
+            // --netplay-sim <one way latency ms> <loss %>, to try netplay out on one machine
+            netplayConditions.latency = atoi(argv[i + 1]) / 1000.0f;
+            netplayConditions.jitter = netplayConditions.latency * 0.1f;
+            netplayConditions.loss = atoi(argv[i + 2]) / 100.0f;
+            i += 2;
+        }
+    }
+    app->netplay.conditions = netplayConditions;
+}
+
+void StartRenderTarget(AppData *app)
+{
+    // Initialize the render texture, used to hold the rendering result so we can easily resize it
+    app->renderTarget = LoadRenderTexture(RENDER_WIDTH, RENDER_HEIGHT);
+    SetTextureFilter(app->renderTarget.texture, TEXTURE_FILTER_BILINEAR);  // Texture scale filter to use
+}
+
+void StartRaylibLogo(AppData *app)
+{
+    app->raylibLogo = InitRaylibLogo();
+}
+
+void StartGameState(AppData *app)
+{
+    app->pong = InitGameState((unsigned int)time(NULL), NULL, NULL); // silent until StartPongAudio()
+}
+
+void StartProfiler(AppData *app)
+{
+    app->profiler = InitProfiler();
+}
+
+void StartAudioDevice(AppData *app)
+{
+    (void)app;
+    InitAudioDevice();
+}
+
+void StartPongAudio(AppData *app)
+{
+    // Games made from this one (netplay, restarts) keep the pointer
+    if (LoadPongAudio(&app->audio))
+        app->pong.audio = &app->audio;
+}
+
+void StartPlayfield(AppData *app)
+{
+    app->playfield = LoadPlayfield();
+}
+
+void StartUiState(AppData *app)
+{
+    app->ui = InitUiState();
+}
+
+void StartRewind(AppData *app)
+{
+    app->rewind = InitRewind(app->rewindSeconds);
+}
@@ -0,0 +1,355 @@
+// EXPLANATION:
+// Two player games over UDP with rollback
+// See netplay.h for more documentation/descriptions
+
+#include "netplay.h"
+
+#include <limits.h> // for UINT_MAX
+#include <string.h> // for memcmp() and memcpy()
+#include "raylib.h"
+
+#include "pong.h"
+#include "rng.h"
+#include "snapshot.h"
+
+#define NETPLAY_NO_MOVE 2 // Input byte for standing still with nothing pressed
+
+// Local Functions Declaration
+// --------------------------------------------------------------------------------
+static void StartNetplayMatch(PongNetplay *net, GameState *pong);
+static void ReadNetplayPacket(PongNetplay *net, const unsigned char *data, int size); // Takes in the other player's inputs
+static void SimulateNetplayTick(PongNetplay *net, GameState *pong, unsigned int tick, bool isResimulating);
+static unsigned char EncodeNetplayInput(const PongInput *input);
+static void SendNetplayPacket(PongNetplay *net, const unsigned char *data, int size, double time); // Through NetplayConditions
+static void FlushNetplayQueue(PongNetplay *net, double time); // Sends held back packets that are due
+static float NextNetplayChance(PongNetplay *net); // 0 to 1
+static void WriteNetplayUint32(unsigned char *data, unsigned int value);
+static unsigned int ReadNetplayUint32(const unsigned char *data);
+
+PongNetplay InitNetplay(NetplaySide side, unsigned short localPort, const char *remoteHost, unsigned short remotePort, unsigned int seed)
+{
+    PongNetplay net = { 0 };
+    net.mode = NETPLAY_OFF;
+    net.side = side;
+    net.seed = seed;
+    net.rollbackTick = UINT_MAX;
+    net.ticksUntilSync = NETPLAY_SYNC_INTERVAL;
+    net.conditionsRng = InitPongRng(seed, (uint32_t)side);
+
+    net.socket = OpenNetSocket(localPort);
+    if (net.socket.handle == -1)
+    {
+        TraceLog(LOG_WARNING, "NETPLAY: Could not open UDP port %i", localPort);
+        return net;
+    }
+    if (!ResolveNetAddress(remoteHost, remotePort, &net.remote))
+    {
+        TraceLog(LOG_WARNING, "NETPLAY: Could not find %s", remoteHost);
+        CloseNetSocket(&net.socket);
+        return net;
+    }
+
+    net.snapshots = MemAlloc(NETPLAY_RING_SIZE * sizeof(PongSnapshot));
+    net.queue = MemAlloc(NETPLAY_QUEUE_SIZE * sizeof(NetplayPacket));
+    net.mode = NETPLAY_WAITING;
+    TraceLog(LOG_INFO, "NETPLAY: Playing the %s paddle on port %i, other player at %s:%i",
+             (side == NETPLAY_LEFT) ? "left" : "right", localPort, remoteHost, remotePort);
+
+    return net;
+}
+
+void CloseNetplay(PongNetplay *net)
+{
+    if (net->mode == NETPLAY_OFF)
+        return;
+
+    CloseNetSocket(&net->socket);
+    MemFree(net->snapshots);
+    MemFree(net->queue);
+    net->snapshots = NULL;
+    net->queue = NULL;
+    net->queueCount = 0;
+    net->mode = NETPLAY_OFF;
+}
+
+void PollNetplay(PongNetplay *net, GameState *pong, double time)
+{
+    if (net->mode == NETPLAY_OFF)
+        return;
+
+    FlushNetplayQueue(net, time);
+
+    unsigned char data[NETPLAY_MAX_PACKET];
+    NetAddress from;
+    int size;
+    while ((size = ReceiveNetPacket(net->socket, &from, data, sizeof(data))) > 0)
+    {
+        // Anything that isn't from the other player or isn't a netplay packet is ignored
+        if (from.host != net->remote.host || from.port != net->remote.port)
+            continue;
+        if (size < NETPLAY_HEADER_SIZE || memcmp(data, "PN", 2) != 0 || data[2] != NETPLAY_VERSION)
+            continue;
+        net->stats.packetsReceived++;
+        net->lastReceiveTime = time;
+
+        // The right side plays with whatever seed the left side picked
+        if (net->mode == NETPLAY_WAITING && net->side == NETPLAY_RIGHT)
+        {
+            net->seed = ReadNetplayUint32(&data[3]);
+            StartNetplayMatch(net, pong);
+        }
+
+        ReadNetplayPacket(net, data, size);
+    }
+
+    // Waiting for the other player to show up is fine, but once they have they shouldn't go quiet
+    if (net->stats.packetsReceived > 0 && time - net->lastReceiveTime > NETPLAY_TIMEOUT)
+    {
+        TraceLog(LOG_WARNING, "NETPLAY: Nothing from the other player for %.0f seconds, leaving the match", NETPLAY_TIMEOUT);
+        CloseNetplay(net);
+        return;
+    }
+
+    if (net->mode == NETPLAY_WAITING && net->side == NETPLAY_LEFT)
+        StartNetplayMatch(net, pong);
+
+    // Go back to the first wrong guess and play it forward again with the real inputs
+    if (net->rollbackTick < net->tick)
+    {
+        unsigned int depth = net->tick - net->rollbackTick;
+        RestorePongSnapshot(pong, &net->snapshots[net->rollbackTick % NETPLAY_RING_SIZE]);
+        for (unsigned int tick = net->rollbackTick; tick < net->tick; tick++)
+            SimulateNetplayTick(net, pong, tick, true);
+
+        net->stats.rollbacks++;
+        net->stats.resimulatedTicks += depth;
+        if (depth > net->stats.maxRollback)
+            net->stats.maxRollback = depth;
+    }
+    net->rollbackTick = UINT_MAX;
+}
+
+bool StepNetplay(PongNetplay *net, GameState *pong, const PongInput *input)
+{
+    if (net->mode != NETPLAY_PLAYING)
+        return false;
+
+    // Too far past the other player's last input to roll back, or they haven't
+    // got enough of ours, so wait for them
+    // (the other player's input can be ahead of us, so this is signed)
+    if ((int)(net->tick - net->remoteTick) >= NETPLAY_MAX_ROLLBACK ||
+        net->tick - net->remoteAck >= NETPLAY_RING_SIZE - NETPLAY_MAX_ROLLBACK)
+    {
+        net->stats.stalledTicks++;
+        return false;
+    }
+
+    // Each side sees the other a trip behind, so comparing how far ahead both
+    // think they are cancels the latency out. The one really ahead waits a tick
+    if (--net->ticksUntilSync <= 0)
+    {
+        net->ticksUntilSync = NETPLAY_SYNC_INTERVAL;
+        int advantage = (int)(net->tick - net->remoteTick);
+        if (advantage - net->remoteAdvantage >= 2)
+        {
+            net->stats.stalledTicks++;
+            return false;
+        }
+    }
+
+    net->localInputs[net->tick % NETPLAY_RING_SIZE] = EncodeNetplayInput(input);
+    SimulateNetplayTick(net, pong, net->tick, false);
+    net->tick++;
+
+    return true;
+}
+
+void SendNetplayInputs(PongNetplay *net, double time)
+{
+    if (net->mode != NETPLAY_PLAYING)
+        return;
+
+    // Every input the other side hasn't acked, as many as fit
+    unsigned int count = net->tick - net->remoteAck;
+    if (count > NETPLAY_MAX_PACKET - NETPLAY_HEADER_SIZE)
+        count = NETPLAY_MAX_PACKET - NETPLAY_HEADER_SIZE;
+    if (count > 255)
+        count = 255;
+
+    int advantage = (int)(net->tick - net->remoteTick);
+    if (advantage > 127)
+        advantage = 127;
+    if (advantage < -128)
+        advantage = -128;
+
+    unsigned char data[NETPLAY_MAX_PACKET];
+    memcpy(data, "PN", 2);
+    data[2] = NETPLAY_VERSION;
+    WriteNetplayUint32(&data[3], net->seed);
+    WriteNetplayUint32(&data[7], net->remoteAck);
+    data[11] = (unsigned char)count;
+    WriteNetplayUint32(&data[12], net->remoteTick);
+    data[16] = (unsigned char)(signed char)advantage;
+    for (unsigned int i = 0; i < count; i++)
+        data[NETPLAY_HEADER_SIZE + i] = net->localInputs[(net->remoteAck + i) % NETPLAY_RING_SIZE];
+
+    SendNetplayPacket(net, data, NETPLAY_HEADER_SIZE + (int)count, time);
+    FlushNetplayQueue(net, time);
+}
+
+static void StartNetplayMatch(PongNetplay *net, GameState *pong)
+{
+    *pong = InitGameState(net->seed, pong->audio, pong->config);
+    StartPongMatch(pong, MODE_2PLAYER, pong->difficulty, net->seed);
+
+    net->tick = 0;
+    net->remoteTick = 0;
+    net->remoteAck = 0;
+    net->remoteAdvantage = 0;
+    net->rollbackTick = UINT_MAX;
+    net->mode = NETPLAY_PLAYING;
+    TraceLog(LOG_INFO, "NETPLAY: Match started with seed %u", net->seed);
+}
+
+static void ReadNetplayPacket(PongNetplay *net, const unsigned char *data, int size)
+{
+    // Leftovers from before the match started
+    if (net->mode != NETPLAY_PLAYING || ReadNetplayUint32(&data[3]) != net->seed)
+        return;
+
+    unsigned int firstTick = ReadNetplayUint32(&data[7]);
+    int count = data[11];
+    unsigned int ack = ReadNetplayUint32(&data[12]);
+    if (size < NETPLAY_HEADER_SIZE + count)
+        return;
+
+    // Packets can arrive out of order, so only move the ack forward
+    if (ack > net->remoteAck && ack <= net->tick)
+        net->remoteAck = ack;
+    net->remoteAdvantage = (signed char)data[16];
+
+    for (int i = 0; i < count; i++)
+    {
+        unsigned int tick = firstTick + (unsigned int)i;
+        if (tick < net->remoteTick)
+            continue; // Already have it
+        if (tick > net->remoteTick || tick >= net->tick + NETPLAY_RING_SIZE - NETPLAY_MAX_ROLLBACK)
+            break; // A gap, the next packet will fill it in
+
+        unsigned int slot = tick % NETPLAY_RING_SIZE;
+        unsigned char input = data[NETPLAY_HEADER_SIZE + i];
+        net->remoteInputs[slot] = input;
+        if (tick < net->tick && net->usedInputs[slot] != input && tick < net->rollbackTick)
+            net->rollbackTick = tick;
+        net->remoteTick++;
+    }
+}
+
+static void SimulateNetplayTick(PongNetplay *net, GameState *pong, unsigned int tick, bool isResimulating)
+{
+    unsigned int slot = tick % NETPLAY_RING_SIZE;
+    net->snapshots[slot] = TakePongSnapshot(pong);
+
+    // Guess the other player keeps moving the same way, without pressing anything
+    unsigned char remote = NETPLAY_NO_MOVE;
+    if (tick < net->remoteTick)
+        remote = net->remoteInputs[slot];
+    else if (net->remoteTick > 0)
+        remote = net->remoteInputs[(net->remoteTick - 1) % NETPLAY_RING_SIZE] & NETPLAY_INPUT_MOVE_MASK;
+    net->usedInputs[slot] = remote;
+
+    unsigned char local = net->localInputs[slot];
+    unsigned char left = (net->side == NETPLAY_LEFT) ? local : remote;
+    unsigned char right = (net->side == NETPLAY_LEFT) ? remote : local;
+
+    PongInput input = { 0 };
+    input.moveL = (float)((left & NETPLAY_INPUT_MOVE_MASK) - NETPLAY_NO_MOVE);
+    input.moveR = (float)((right & NETPLAY_INPUT_MOVE_MASK) - NETPLAY_NO_MOVE);
+    input.pausePressed = ((left | right) & NETPLAY_INPUT_PAUSE) != 0;
+    input.skipPressed = ((left | right) & NETPLAY_INPUT_SKIP) != 0;
+
+    // Sounds already played the first time through
+    PongAudio *audio = pong->audio;
+    if (isResimulating)
+        pong->audio = NULL;
+    StepPong(pong, &input, SIM_TIMESTEP);
+    pong->audio = audio;
+}
+
+static unsigned char EncodeNetplayInput(const PongInput *input)
+{
+    // Either set of keys moves the local paddle
+    float move = (input->moveL != 0.0f) ? input->moveL : input->moveR;
+    if (move < -2.0f)
+        move = -2.0f;
+    if (move > 2.0f)
+        move = 2.0f;
+
+    unsigned char encoded = (unsigned char)((int)move + NETPLAY_NO_MOVE);
+    if (input->pausePressed)
+        encoded |= NETPLAY_INPUT_PAUSE;
+    if (input->skipPressed)
+        encoded |= NETPLAY_INPUT_SKIP;
+
+    return encoded;
+}
+
+static void SendNetplayPacket(PongNetplay *net, const unsigned char *data, int size, double time)
+{
+    net->stats.packetsSent++;
+
+    const NetplayConditions *conditions = &net->conditions;
+    if (conditions->latency <= 0.0f && conditions->jitter <= 0.0f && conditions->loss <= 0.0f)
+    {
+        SendNetPacket(net->socket, net->remote, data, size);
+        return;
+    }
+
+    // A full queue drops packets, like a router would
+    if (NextNetplayChance(net) < conditions->loss || net->queueCount == NETPLAY_QUEUE_SIZE)
+    {
+        net->stats.packetsDropped++;
+        return;
+    }
+
+    NetplayPacket *packet = &net->queue[net->queueCount++];
+    packet->sendTime = time + conditions->latency + conditions->jitter * (NextNetplayChance(net) * 2.0f - 1.0f);
+    packet->size = size;
+    memcpy(packet->data, data, (size_t)size);
+}
+
+static void FlushNetplayQueue(PongNetplay *net, double time)
+{
+    // Jitter can let later packets go first, same as a real network
+    int kept = 0;
+    for (int i = 0; i < net->queueCount; i++)
+    {
+        NetplayPacket *packet = &net->queue[i];
+        if (packet->sendTime <= time)
+            SendNetPacket(net->socket, net->remote, packet->data, packet->size);
+        else if (kept != i)
+            net->queue[kept++] = *packet;
+        else
+            kept++;
+    }
+    net->queueCount = kept;
+}
+
+static float NextNetplayChance(PongNetplay *net)
+{
+    return (float)(NextPongRng(&net->conditionsRng) >> 8) / (float)(1 << 24);
+}
+
+static void WriteNetplayUint32(unsigned char *data, unsigned int value)
+{
+    data[0] = (unsigned char)value;
+    data[1] = (unsigned char)(value >> 8);
+    data[2] = (unsigned char)(value >> 16);
+    data[3] = (unsigned char)(value >> 24);
+}
+
+static unsigned int ReadNetplayUint32(const unsigned char *data)
+{
+    return (unsigned int)data[0] | ((unsigned int)data[1] << 8) |
+           ((unsigned int)data[2] << 16) | ((unsigned int)data[3] << 24);
+}
@@ -0,0 +1,115 @@
+// EXPLANATION:
+// Two player games over UDP with rollback, so neither player waits on the network
+// Every step runs straight away with the local player's input and a guess of the
+// other player's (the last one received). When their real input arrives and the
+// guess was wrong, the game goes back to the snapshot from that step and simulates
+// forward again, all before the frame is drawn. Local input shows up on the next
+// frame no matter the ping, as long as it's under NETPLAY_MAX_ROLLBACK ticks each way
+//
+// The left side picks the seed and starts right away, the right side starts when
+// its first packet arrives. Packets can be held back and dropped on purpose with
+// NetplayConditions, to try it out on one machine (see tools/netstress.c)
+//
+// Packet layout (all numbers little endian):
+//   "PN", version (1 byte), seed (4 bytes), first tick (4 bytes), input count (1 byte),
+//   ack (4 bytes), advantage (1 byte, signed), then one byte per input
+//   Every packet has all the inputs the other side hasn't acked yet, so a lost packet
+//   is made up for by the next one
+//   Input bytes: move + 2 in the low 4 bits, then NETPLAY_INPUT_* flags
+
+#ifndef PONG_NETPLAY_HEADER_GUARD
+#define PONG_NETPLAY_HEADER_GUARD
+
+#include "states.h"
+#include "netsocket.h"
+#include "snapshot.h"
+
+// Macros
+// --------------------------------------------------------------------------------
+#define NETPLAY_VERSION 1
+#define NETPLAY_HEADER_SIZE 17
+#define NETPLAY_MAX_PACKET 256
+#define NETPLAY_MAX_ROLLBACK 48   // Ticks (200 ms) the game can run ahead of the other player's input before it waits
+#define NETPLAY_RING_SIZE 128     // Ticks of inputs and snapshots kept, power of two and at least 2 * NETPLAY_MAX_ROLLBACK
+#define NETPLAY_QUEUE_SIZE 256    // Packets NetplayConditions can hold back at once
+#define NETPLAY_SYNC_INTERVAL 24  // Ticks between checks that both sides run at the same pace
+#define NETPLAY_TIMEOUT 5.0       // Seconds without a packet from the other player before giving up on the match
+
+// Input flags
+#define NETPLAY_INPUT_MOVE_MASK 0x0f
+#define NETPLAY_INPUT_PAUSE     0x10
+#define NETPLAY_INPUT_SKIP      0x20
+
+// Types and Structures
+// --------------------------------------------------------------------------------
+typedef enum NetplayMode
+{
+    NETPLAY_OFF, NETPLAY_WAITING, NETPLAY_PLAYING // waiting: for the seed, or to start the match
+} NetplayMode;
+
+typedef enum NetplaySide { NETPLAY_LEFT, NETPLAY_RIGHT } NetplaySide;
+
+typedef struct NetplayConditions // Pretend network, applied to packets as they're sent
+{
+    float latency; // One way, seconds
+    float jitter;  // Up to this much more or less latency per packet, seconds
+    float loss;    // Chance of dropping each packet, 0 to 1
+} NetplayConditions;
+
+typedef struct NetplayPacket // A packet held back by NetplayConditions
+{
+    double sendTime;
+    int size;
+    unsigned char data[NETPLAY_MAX_PACKET];
+} NetplayPacket;
+
+typedef struct NetplayStats
+{
+    unsigned int rollbacks; // Times a wrong guess was corrected
+    unsigned int resimulatedTicks;
+    unsigned int maxRollback; // Most ticks gone back at once
+    unsigned int stalledTicks; // Steps skipped, waiting for the other player or letting them catch up
+    unsigned int packetsSent;
+    unsigned int packetsReceived;
+    unsigned int packetsDropped; // By NetplayConditions
+} NetplayStats;
+
+typedef struct PongNetplay
+{
+    NetplayMode mode;
+    NetplaySide side;
+    NetSocket socket;
+    NetAddress remote;
+    unsigned int seed; // Picked by the left side
+
+    unsigned int tick;        // Next tick to simulate
+    unsigned int remoteTick;  // The other player's input is known for every tick before this
+    unsigned int remoteAck;   // The other side has our input for every tick before this
+    int remoteAdvantage;      // How far ahead of us the other side says it is
+    unsigned int rollbackTick; // Earliest tick simulated with a wrong guess, UINT_MAX if there's none
+    int ticksUntilSync;
+    double lastReceiveTime; // When the last packet from the other player came in
+
+    // Indexed by tick % NETPLAY_RING_SIZE
+    unsigned char localInputs[NETPLAY_RING_SIZE];
+    unsigned char remoteInputs[NETPLAY_RING_SIZE];
+    unsigned char usedInputs[NETPLAY_RING_SIZE]; // The other player's input each tick was simulated with
+    PongSnapshot *snapshots; // The game before each tick
+
+    NetplayConditions conditions;
+    PongRng conditionsRng;
+    NetplayPacket *queue; // Held back packets, in the order they were sent
+    int queueCount;
+
+    NetplayStats stats;
+} PongNetplay;
+
+// Prototypes
+// --------------------------------------------------------------------------------
+PongNetplay InitNetplay(NetplaySide side, unsigned short localPort, const char *remoteHost, unsigned short remotePort, unsigned int seed); // mode is NETPLAY_OFF if the socket can't be opened
+void CloseNetplay(PongNetplay *net);
+void PollNetplay(PongNetplay *net, GameState *pong, double time); // Reads packets, starts the match, and fixes wrong guesses. Call before stepping
+bool StepNetplay(PongNetplay *net, GameState *pong, const PongInput *input); // One tick with the local player's input, false if it had to wait instead
+void SendNetplayInputs(PongNetplay *net, double time); // Call after stepping, once per frame is enough
+
+#endif // PONG_NETPLAY_HEADER_GUARD
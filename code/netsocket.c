@@ -0,0 +1,171 @@
+// EXPLANATION:
+// Minimal non-blocking UDP sockets for netplay
+// See netsocket.h for more documentation/descriptions
+
+#include "netsocket.h"
+
+#include <stddef.h> // for NULL
+#include <string.h> // for memset()
+
+#if defined(_WIN32)
+    #include <winsock2.h>
+    #include <ws2tcpip.h>
+#elif !defined(__EMSCRIPTEN__)
+    #include <errno.h>
+    #include <fcntl.h>
+    #include <netdb.h> // for getaddrinfo()
+    #include <netinet/in.h>
+    #include <sys/socket.h>
+    #include <unistd.h> // for close()
+#endif
+
+#if defined(__EMSCRIPTEN__)
+
+// Browsers don't allow UDP, so every socket fails to open
+NetSocket OpenNetSocket(uint16_t port) { (void)port; return (NetSocket){ -1 }; }
+void CloseNetSocket(NetSocket *netSocket) { netSocket->handle = -1; }
+bool ResolveNetAddress(const char *host, uint16_t port, NetAddress *address) { (void)host; (void)port; (void)address; return false; }
+bool SendNetPacket(NetSocket netSocket, NetAddress to, const void *data, int size) { (void)netSocket; (void)to; (void)data; (void)size; return false; }
+int ReceiveNetPacket(NetSocket netSocket, NetAddress *from, void *buffer, int capacity) { (void)netSocket; (void)from; (void)buffer; (void)capacity; return -1; }
+
+#else
+
+// Local Functions Declaration
+// --------------------------------------------------------------------------------
+static bool InitNetSockets(void); // Starts Winsock the first time, nothing to do elsewhere
+
+NetSocket OpenNetSocket(uint16_t port)
+{
+    NetSocket netSocket = { -1 };
+    if (!InitNetSockets())
+        return netSocket;
+
+#if defined(_WIN32)
+    SOCKET handle = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (handle == INVALID_SOCKET)
+        return netSocket;
+#else
+    int handle = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (handle < 0)
+        return netSocket;
+#endif
+    netSocket.handle = (intptr_t)handle;
+
+    struct sockaddr_in address;
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_ANY);
+    address.sin_port = htons(port);
+    if (bind(handle, (struct sockaddr *)&address, sizeof(address)) != 0)
+    {
+        CloseNetSocket(&netSocket);
+        return netSocket;
+    }
+
+    // Reads return straight away, the game polls once per frame
+#if defined(_WIN32)
+    u_long nonBlocking = 1;
+    bool isNonBlocking = (ioctlsocket(handle, FIONBIO, &nonBlocking) == 0);
+#else
+    bool isNonBlocking = (fcntl(handle, F_SETFL, fcntl(handle, F_GETFL, 0) | O_NONBLOCK) == 0);
+#endif
+    if (!isNonBlocking)
+        CloseNetSocket(&netSocket);
+
+    return netSocket;
+}
+
+void CloseNetSocket(NetSocket *netSocket)
+{
+    if (netSocket->handle == -1)
+        return;
+
+#if defined(_WIN32)
+    closesocket((SOCKET)netSocket->handle);
+#else
+    close((int)netSocket->handle);
+#endif
+    netSocket->handle = -1;
+}
+
+bool ResolveNetAddress(const char *host, uint16_t port, NetAddress *address)
+{
+    if (!InitNetSockets())
+        return false;
+
+    struct addrinfo hints;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_DGRAM;
+
+    struct addrinfo *result = NULL;
+    if (getaddrinfo(host, NULL, &hints, &result) != 0 || result == NULL)
+        return false;
+
+    address->host = ((struct sockaddr_in *)result->ai_addr)->sin_addr.s_addr;
+    address->port = htons(port);
+    freeaddrinfo(result);
+
+    return true;
+}
+
+bool SendNetPacket(NetSocket netSocket, NetAddress to, const void *data, int size)
+{
+    struct sockaddr_in address;
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = to.host;
+    address.sin_port = to.port;
+
+#if defined(_WIN32)
+    int sent = sendto((SOCKET)netSocket.handle, (const char *)data, size, 0, (struct sockaddr *)&address, sizeof(address));
+#else
+    int sent = (int)sendto((int)netSocket.handle, data, (size_t)size, 0, (struct sockaddr *)&address, sizeof(address));
+#endif
+
+    return (sent == size);
+}
+
+int ReceiveNetPacket(NetSocket netSocket, NetAddress *from, void *buffer, int capacity)
+{
+    struct sockaddr_in address;
+#if defined(_WIN32)
+    int addressSize = sizeof(address);
+    int received = recvfrom((SOCKET)netSocket.handle, (char *)buffer, capacity, 0, (struct sockaddr *)&address, &addressSize);
+    if (received < 0)
+    {
+        int error = WSAGetLastError();
+        return (error == WSAEWOULDBLOCK || error == WSAECONNRESET) ? 0 : -1; // reset: the other side isn't up yet
+    }
+#else
+    socklen_t addressSize = sizeof(address);
+    int received = (int)recvfrom((int)netSocket.handle, buffer, (size_t)capacity, 0, (struct sockaddr *)&address, &addressSize);
+    if (received < 0)
+        return (errno == EAGAIN || errno == EWOULDBLOCK || errno == ECONNREFUSED) ? 0 : -1;
+#endif
+
+    if (from != NULL)
+    {
+        from->host = address.sin_addr.s_addr;
+        from->port = address.sin_port;
+    }
+
+    return received;
+}
+
+static bool InitNetSockets(void)
+{
+#if defined(_WIN32)
+    static bool started = false;
+    if (!started)
+    {
+        WSADATA data;
+        started = (WSAStartup(MAKEWORD(2, 2), &data) == 0);
+    }
+    return started;
+#else
+    return true;
+#endif
+}
+
+#endif // __EMSCRIPTEN__
@@ -0,0 +1,34 @@
+// EXPLANATION:
+// Minimal non-blocking UDP sockets for netplay
+// Kept apart from everything else because the Windows socket headers clash with
+// raylib's names, so this is the only file that includes them and it never includes raylib.h
+// Not available on the web, where browsers don't allow UDP
+
+#ifndef PONG_NETSOCKET_HEADER_GUARD
+#define PONG_NETSOCKET_HEADER_GUARD
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Types and Structures
+// --------------------------------------------------------------------------------
+typedef struct NetAddress // IPv4 address and port, both in network byte order
+{
+    uint32_t host;
+    uint16_t port;
+} NetAddress;
+
+typedef struct NetSocket
+{
+    intptr_t handle; // -1 when closed (a SOCKET on Windows, a file descriptor elsewhere)
+} NetSocket;
+
+// Prototypes
+// --------------------------------------------------------------------------------
+NetSocket OpenNetSocket(uint16_t port); // Binds to every interface, handle is -1 on failure
+void CloseNetSocket(NetSocket *netSocket);
+bool ResolveNetAddress(const char *host, uint16_t port, NetAddress *address); // Host name or dotted IPv4
+bool SendNetPacket(NetSocket netSocket, NetAddress to, const void *data, int size);
+int ReceiveNetPacket(NetSocket netSocket, NetAddress *from, void *buffer, int capacity); // Bytes received, 0 if nothing is waiting, -1 on errors
+
+#endif // PONG_NETSOCKET_HEADER_GUARD
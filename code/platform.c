@@ -0,0 +1,147 @@
+// EXPLANATION:
+// A monotonic clock, threads and locks for the headless tools, on Windows and everywhere else
+// See platform.h for more documentation/descriptions
+
+#include "platform.h"
+
+#include <stdlib.h> // for malloc() and free(), raylib's MemAlloc() can't be included here
+
+#if defined(_WIN32)
+    #define WIN32_LEAN_AND_MEAN
+    #include <windows.h>
+#else
+    #include <pthread.h>
+    #include <time.h>   // for clock_gettime()
+    #include <unistd.h> // for sysconf()
+#endif
+
+// Local Functions Declaration
+// --------------------------------------------------------------------------------
+#if defined(_WIN32)
+static DWORD WINAPI RunPlatformThread(LPVOID thread);
+#else
+static void *RunPlatformThread(void *thread);
+#endif
+
+double GetWallTime(void)
+{
+#if defined(_WIN32)
+    LARGE_INTEGER frequency, now;
+    QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&now);
+    return (double)now.QuadPart / (double)frequency.QuadPart;
+#else
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec / 1e9;
+#endif
+}
+
+int GetCpuCount(void)
+{
+#if defined(_WIN32)
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    int count = (int)info.dwNumberOfProcessors;
+#else
+    int count = (int)sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+    return (count > 0) ? count : 1;
+}
+
+bool StartPlatformThread(PlatformThread *thread, void (*run)(void *arg), void *arg)
+{
+    thread->run = run;
+    thread->arg = arg;
+#if defined(_WIN32)
+    thread->handle = CreateThread(NULL, 0, RunPlatformThread, thread, 0, NULL);
+    return (thread->handle != NULL);
+#else
+    pthread_t *handle = malloc(sizeof(pthread_t));
+    if (handle != NULL && pthread_create(handle, NULL, RunPlatformThread, thread) != 0)
+    {
+        free(handle);
+        handle = NULL;
+    }
+    thread->handle = handle;
+    return (handle != NULL);
+#endif
+}
+
+void JoinPlatformThread(PlatformThread *thread)
+{
+    if (thread->handle == NULL)
+        return;
+
+#if defined(_WIN32)
+    WaitForSingleObject(thread->handle, INFINITE);
+    CloseHandle(thread->handle);
+#else
+    pthread_join(*(pthread_t *)thread->handle, NULL);
+    free(thread->handle);
+#endif
+    thread->handle = NULL;
+}
+
+PlatformMutex InitPlatformMutex(void)
+{
+#if defined(_WIN32)
+    CRITICAL_SECTION *handle = malloc(sizeof(CRITICAL_SECTION));
+    if (handle != NULL)
+        InitializeCriticalSection(handle);
+#else
+    pthread_mutex_t *handle = malloc(sizeof(pthread_mutex_t));
+    if (handle != NULL && pthread_mutex_init(handle, NULL) != 0)
+    {
+        free(handle);
+        handle = NULL;
+    }
+#endif
+    return (PlatformMutex){ handle };
+}
+
+void FreePlatformMutex(PlatformMutex *mutex)
+{
+    if (mutex->handle == NULL)
+        return;
+
+#if defined(_WIN32)
+    DeleteCriticalSection(mutex->handle);
+#else
+    pthread_mutex_destroy(mutex->handle);
+#endif
+    free(mutex->handle);
+    mutex->handle = NULL;
+}
+
+void LockPlatformMutex(PlatformMutex *mutex)
+{
+#if defined(_WIN32)
+    EnterCriticalSection(mutex->handle);
+#else
+    pthread_mutex_lock(mutex->handle);
+#endif
+}
+
+void UnlockPlatformMutex(PlatformMutex *mutex)
+{
+#if defined(_WIN32)
+    LeaveCriticalSection(mutex->handle);
+#else
+    pthread_mutex_unlock(mutex->handle);
+#endif
+}
+
+#if defined(_WIN32)
+static DWORD WINAPI RunPlatformThread(LPVOID thread)
+{
+    ((PlatformThread *)thread)->run(((PlatformThread *)thread)->arg);
+    return 0;
+}
+#else
+static void *RunPlatformThread(void *thread)
+{
+    ((PlatformThread *)thread)->run(((PlatformThread *)thread)->arg);
+    return NULL;
+}
+#endif
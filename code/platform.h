@@ -0,0 +1,39 @@
+// EXPLANATION:
+// A monotonic clock, threads and locks for the headless tools, on Windows and everywhere else
+// Kept apart from everything else because the Windows headers clash with raylib's
+// names, so like netsocket.c this file never includes raylib.h
+// raylib's GetTime() only works once a window is open, which the tools never do
+
+#ifndef PONG_PLATFORM_HEADER_GUARD
+#define PONG_PLATFORM_HEADER_GUARD
+
+#include <stdbool.h>
+
+// Types and Structures
+// --------------------------------------------------------------------------------
+typedef struct PlatformThread // Must stay where it is until JoinPlatformThread()
+{
+    void *handle;
+    void (*run)(void *arg);
+    void *arg;
+} PlatformThread;
+
+typedef struct PlatformMutex
+{
+    void *handle; // A CRITICAL_SECTION on Windows, a pthread_mutex_t elsewhere, NULL if it couldn't be made
+} PlatformMutex;
+
+// Prototypes
+// --------------------------------------------------------------------------------
+double GetWallTime(void); // Seconds since some fixed point, never goes backwards
+int GetCpuCount(void); // Logical cores, at least 1
+
+bool StartPlatformThread(PlatformThread *thread, void (*run)(void *arg), void *arg);
+void JoinPlatformThread(PlatformThread *thread); // Waits for run() to return
+
+PlatformMutex InitPlatformMutex(void);
+void FreePlatformMutex(PlatformMutex *mutex);
+void LockPlatformMutex(PlatformMutex *mutex);
+void UnlockPlatformMutex(PlatformMutex *mutex);
+
+#endif // PONG_PLATFORM_HEADER_GUARD
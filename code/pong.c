@@ -4,55 +4,101 @@
 
 #include "pong.h"
 
-#include <limits.h> // for SHRT_MAX
+#include <stddef.h> // for NULL
+#include <stdio.h> // for sscanf()
+#include <stdlib.h> // for strtod()
+#include <string.h> // for strchr() and strcmp()
 #include "raymath.h" // needed for vector math
+#include "rlgl.h" // needed to batch the ball and paddles
+#include "render.h" // raylib or the software canvas
 
 #include "config.h"
 #include "ui.h" // needed to reset the title menu
+#include "replay.h"
+#include "rng.h"
 
 #define ARRAY_SIZE(arr) (sizeof(arr) / sizeof((arr)[0]))
 
-GameState InitGameState(void)
+// Paddle hit directions, worked out at compile time so bounces don't need sinf() and cosf()
+// The table goes past the paddle's end, as far as a ball hanging half over the edge can hit
+// Hits are rounded to the nearest entry, at most 0.19 degrees off with the default tweaks
+// (half of PADDLE_HIT_MAX_ANGLE * PADDLE_HIT_RANGE / PADDLE_HIT_STEPS)
+#define PADDLE_HIT_RANGE (1.0f + (float)BALL_SIZE / PADDLE_LENGTH)
+#define PADDLE_HIT_ANGLE(i) ((float)(i) / PADDLE_HIT_STEPS * PADDLE_HIT_RANGE * PADDLE_HIT_MAX_ANGLE * (PI / 180.0f))
+#define PADDLE_HIT_DIRECTION(i) { POLY_COS(PADDLE_HIT_ANGLE(i)), POLY_SIN(PADDLE_HIT_ANGLE(i)) }
+#define PADDLE_HIT_DIRECTIONS_4(i) PADDLE_HIT_DIRECTION(i), PADDLE_HIT_DIRECTION(i + 1), \
+                                   PADDLE_HIT_DIRECTION(i + 2), PADDLE_HIT_DIRECTION(i + 3)
+#define PADDLE_HIT_DIRECTIONS_32(i) PADDLE_HIT_DIRECTIONS_4(i), PADDLE_HIT_DIRECTIONS_4(i + 4), \
+                                    PADDLE_HIT_DIRECTIONS_4(i + 8), PADDLE_HIT_DIRECTIONS_4(i + 12), \
+                                    PADDLE_HIT_DIRECTIONS_4(i + 16), PADDLE_HIT_DIRECTIONS_4(i + 20), \
+                                    PADDLE_HIT_DIRECTIONS_4(i + 24), PADDLE_HIT_DIRECTIONS_4(i + 28)
+
+// Fails to compile if PADDLE_HIT_STEPS changes without the table, the missing entries would be zeros that stop the ball
+typedef char PaddleHitStepsCheck[(PADDLE_HIT_STEPS == 128) ? 1 : -1];
+
+// Local Variables Definition
+// --------------------------------------------------------------------------------
+// Listed out for PADDLE_HIT_STEPS of 128, change both together
+static const Vector2 paddleHitDirections[PADDLE_HIT_STEPS + 1] = {
+    PADDLE_HIT_DIRECTIONS_32(0), PADDLE_HIT_DIRECTIONS_32(32),
+    PADDLE_HIT_DIRECTIONS_32(64), PADDLE_HIT_DIRECTIONS_32(96),
+    PADDLE_HIT_DIRECTION(128)
+};
+
+GameState InitGameState(unsigned int seed, PongAudio *audio, const PongConfig *config)
 {
-    // Start the ball in any random direction
-    float ballStartDirectionX = (float)(GetRandomValue(0, 1) * 2 - 1) * 100; // either -100 or +100
-    float ballStartDirectionY = (float)GetRandomValue(-100, 100);
+    if (config == NULL)
+        config = &defaultPongConfig;
+    const PongConfig *rules = PONG_CONFIG(config);
+
+    PongRng rng = InitPongRng(seed, 0);
     GameState pong =
     {
         .currentScreen = SCREEN_LOGO,
+        .audio = audio,
+        .config = config,
         .ball = {
             .position = {
-                RENDER_WIDTH / 2 - BALL_SIZE / 2,
-                RENDER_HEIGHT / 2 - BALL_SIZE / 2,
-            },
-            .direction = {
-                ballStartDirectionX,
-                ballStartDirectionY,
+                RENDER_WIDTH / 2 - rules->ballSize / 2,
+                RENDER_HEIGHT / 2 - rules->ballSize / 2,
             },
-            .speed = BALL_SPEED,
-            .size = BALL_SIZE,
+            .direction = GetServeDirection(&rng), // any random direction
+            .speed = rules->ballSpeed,
+            .size = rules->ballSize,
+            .paddleHits = 0,
+            .trajectoryId = 1, // paddles start with no prediction (0)
         },
 
         .paddleL = {
             .position = {
-                PADDLE_WIDTH * 1.5,
+                rules->paddleWidth * 1.5,
                 RENDER_HEIGHT / 2,
             },
             .nextHitPos = 0.0f,
-            .speed = PADDLE_SPEED,
-            .length = PADDLE_LENGTH,
-            .width = PADDLE_WIDTH,
+            .ai = GetComputerAi(DIFFICULTY_MEDIUM, config),
+            .predictionId = 0,
+            .targetY = RENDER_HEIGHT / 2,
+            .nextTargetY = RENDER_HEIGHT / 2,
+            .reactionTimer = 0.0f,
+            .speed = rules->paddleSpeed,
+            .length = rules->paddleLength,
+            .width = rules->paddleWidth,
         },
 
         .paddleR = {
             .position = {
-                RENDER_WIDTH - PADDLE_WIDTH * 2.5,
+                RENDER_WIDTH - rules->paddleWidth * 2.5,
                 RENDER_HEIGHT / 2,
             },
             .nextHitPos = 0.0f,
-            .speed = PADDLE_SPEED,
-            .length = PADDLE_LENGTH,
-            .width = PADDLE_WIDTH,
+            .ai = GetComputerAi(DIFFICULTY_MEDIUM, config),
+            .predictionId = 0,
+            .targetY = RENDER_HEIGHT / 2,
+            .nextTargetY = RENDER_HEIGHT / 2,
+            .reactionTimer = 0.0f,
+            .speed = rules->paddleSpeed,
+            .length = rules->paddleLength,
+            .width = rules->paddleWidth,
         },
         .currentMode = 0, // (selected at title screen)
         .difficulty = DIFFICULTY_MEDIUM,
@@ -62,73 +108,144 @@ GameState InitGameState(void)
         .isPaused   = false,
         .gameShouldExit      = false,
         .textFade   = 0.0f,
+        .textFadingOut       = false,
         .textFadeTimeElapsed = 0.0f,
-        .winTimer   = WIN_PAUSE_TIME,
-        .scoreTimer = SCORE_PAUSE_TIME,
+        .winTimer   = rules->winPauseTime,
+        .scoreTimer = rules->scorePauseTime,
     };
-
-    // Allocate memory for beep sine waves
-    pong.beeps[BEEP_MENU] = GenBeep(200.0f, 0.03f);
-    pong.beeps[BEEP_PADDLE] = GenBeep(450.0f, 0.1f);
-    pong.beeps[BEEP_EDGE] = GenBeep(500.0f, 0.1f);
-    pong.beeps[BEEP_SCORE] = GenBeep(600.0f, 0.4f);
+    pong.rng = rng; // after the serve was rolled
 
     return pong;
 }
 
-// Generate a sine wave buffer for a beep
-Sound GenBeep(float freq, float lengthSec)
+bool LoadPongConfig(PongConfig *config, const char *fileName)
 {
-    int sampleRate = 44100;
-    int samples = (int)(lengthSec * sampleRate);
-    short *data = MemAlloc(samples * sizeof(short));
-
-    // fade length in samples (5 ms)
-    int fadeSamples = (int)(0.005f * sampleRate);
-
-    for (int i = 0; i < samples; i++)
+    char *text = LoadFileText(fileName);
+    if (text == NULL)
+        return false;
+
+#if defined(PONG_FIXED_CONFIG)
+    TraceLog(LOG_WARNING, "CONFIG: [%s] Built with PONG_FIXED_CONFIG, matches will keep the defaults", fileName);
+#endif
+
+    // One "name = value" per line, anything after a # is a comment
+    int lineNumber = 0;
+    char *next = text;
+    while (next != NULL)
     {
-        float timeInSeconds = (float)i / sampleRate;
-        float sample = sinf(2.0f * PI * freq * timeInSeconds);
+        char *line = next;
+        next = strchr(line, '\n');
+        if (next != NULL)
+            *next++ = '\0';
+        lineNumber++;
+
+        char *comment = strchr(line, '#');
+        if (comment != NULL)
+            *comment = '\0';
+
+        char name[64] = { 0 };
+        char value[64] = { 0 };
+        int fieldCount = sscanf(line, " %63[A-Za-z] = %63s", name, value);
+        if (fieldCount <= 0)
+            continue; // blank line
+        if (fieldCount != 2)
+        {
+            TraceLog(LOG_WARNING, "CONFIG: [%s] Line %i isn't \"name = value\"", fileName, lineNumber);
+            continue;
+        }
 
-        // envelope factor
-        float amp = 1.0f;
-        if (i < fadeSamples) {
-            amp = (float)i / fadeSamples; // fade in
-        } else if (i > samples - fadeSamples) {
-            amp = (float)(samples - i) / fadeSamples; // fade out
+        char *valueEnd = NULL;
+        double number = strtod(value, &valueEnd);
+        if (*valueEnd != '\0')
+        {
+            TraceLog(LOG_WARNING, "CONFIG: [%s] Line %i: \"%s\" isn't a number", fileName, lineNumber, value);
+            continue;
         }
 
-        data[i] = (short)(sample * amp * SHRT_MAX * 0.25f);
+        // Out of range values are skipped like bad lines, zero sized paddles and the like break the game
+        bool found = false;
+        #define PONG_CONFIG_PARSE(type, field, defaultValue, lowest, highest) \
+            if (strcmp(name, #field) == 0) \
+            { \
+                found = true; \
+                if (number >= (lowest) && number <= (highest)) \
+                    config->field = (type)number; \
+                else \
+                    TraceLog(LOG_WARNING, "CONFIG: [%s] Line %i: %s must be from %g to %g", \
+                             fileName, lineNumber, #field, (double)(lowest), (double)(highest)); \
+            }
+        PONG_CONFIG_FIELDS(PONG_CONFIG_PARSE)
+        #undef PONG_CONFIG_PARSE
+        if (!found)
+            TraceLog(LOG_WARNING, "CONFIG: [%s] Line %i: unknown setting \"%s\"", fileName, lineNumber, name);
     }
+    UnloadFileText(text);
+
+    config->minimumVerticalSin = sinf(config->minimumVerticalAngle * (PI / 180.0f));
+    return true;
+}
 
-    Wave w = {
-        .frameCount = samples,
-        .sampleRate = sampleRate,
-        .sampleSize = 16,
-        .channels = 1,
-        .data = data
+void StartPongMatch(GameState *pong, GameMode mode, GameDifficulty difficulty, unsigned int seed)
+{
+    // Everything random after this point comes from the seed,
+    // so roll the first serve again
+    pong->rng = InitPongRng(seed, 0);
+    pong->ball.direction = GetServeDirection(&pong->rng);
+
+    pong->currentMode = mode;
+    SetGameDifficulty(pong, difficulty);
+    pong->currentScreen = SCREEN_GAMEPLAY;
+}
+
+Vector2 GetServeDirection(PongRng *rng)
+{
+    float directionX = (float)(GetPongRngValue(rng, 0, 1) * 2 - 1) * 100; // either -100 or +100
+    float directionY = (float)GetPongRngValue(rng, -100, 100);
+    return (Vector2){ directionX, directionY };
+}
+
+ComputerAi GetComputerAi(GameDifficulty difficulty, const PongConfig *config)
+{
+    // Every difficulty moves equally fast, they differ in how quickly
+    // and how accurately they read the ball
+    ComputerAi ai =
+    {
+        .reactionDelay = 0.2f,
+        .aimError = 35.0f,
+        .speed = PONG_CONFIG(config)->paddleSpeed * 2,
+        .slowdownAfterHit = 3.0f,
+        .hitStrategy = HIT_RANDOM,
     };
 
-    Sound beep = LoadSoundFromWave(w);
-    UnloadWave(w); // frees data
-    return beep;
+    if (difficulty == DIFFICULTY_EASY)
+    {
+        ai.reactionDelay = 0.35f;
+        ai.aimError = 65.0f;
+    }
+    else if (difficulty == DIFFICULTY_HARD)
+    {
+        ai.reactionDelay = 0.08f;
+        ai.aimError = 15.0f;
+    }
+
+    return ai;
 }
 
-void FreeBeeps(GameState *pong)
+void SetGameDifficulty(GameState *pong, GameDifficulty difficulty)
 {
-    for (unsigned int i = 0; i < ARRAY_SIZE(pong->beeps); i++)
-        UnloadSound(pong->beeps[i]);
+    pong->difficulty = difficulty;
+    pong->paddleL.ai = GetComputerAi(difficulty, pong->config);
+    pong->paddleR.ai = GetComputerAi(difficulty, pong->config);
 }
 
-bool CheckCollisionBallPaddle(Ball ball, Paddle paddle)
+bool CheckCollisionBallPaddle(const Ball *ball, const Paddle *paddle)
 {
     bool collision = false;
 
-    if ((ball.position.x < (paddle.position.x + paddle.width) &&
-         (ball.position.x + ball.size) > paddle.position.x) &&
-        (ball.position.y < (paddle.position.y + paddle.length) &&
-         (ball.position.y + ball.size) > paddle.position.y))
+    if ((ball->position.x < (paddle->position.x + paddle->width) &&
+         (ball->position.x + ball->size) > paddle->position.x) &&
+        (ball->position.y < (paddle->position.y + paddle->length) &&
+         (ball->position.y + ball->size) > paddle->position.y))
         collision = true;
 
     return collision;
@@ -144,6 +261,7 @@ void EdgeCollisionPaddle(Paddle *paddle)
 
 void BounceBallEdge(GameState *pong)
 {
+    const PongConfig *rules = PONG_CONFIG(pong->config);
     bool leftEdgeCollide = (pong->ball.position.x <= 0);
     bool rightEdgeCollide = (pong->ball.position.x + pong->ball.size >= RENDER_WIDTH);
     bool topEdgeCollide = (pong->ball.position.y <= FIELD_LINE_WIDTH);
@@ -159,9 +277,9 @@ void BounceBallEdge(GameState *pong)
         else
         {
             pong->scoreR += 1;
-            pong->scoreTimer = SCORE_PAUSE_TIME;
-            if (pong->scoreR != WIN_SCORE)
-                ResetBall(&pong->ball);
+            pong->scoreTimer = rules->scorePauseTime;
+            if (pong->scoreR != rules->winScore)
+                ResetBall(&pong->ball, &pong->rng, pong->config);
         }
     }
     if (rightEdgeCollide && pong->ball.direction.x > 0)
@@ -174,9 +292,9 @@ void BounceBallEdge(GameState *pong)
         else
         {
             pong->scoreL += 1;
-            pong->scoreTimer = SCORE_PAUSE_TIME;
-            if (pong->scoreL != WIN_SCORE)
-                ResetBall(&pong->ball);
+            pong->scoreTimer = rules->scorePauseTime;
+            if (pong->scoreL != rules->winScore)
+                ResetBall(&pong->ball, &pong->rng, pong->config);
         }
     }
     if (topEdgeCollide && pong->ball.direction.y < 0)
@@ -193,17 +311,23 @@ void BounceBallEdge(GameState *pong)
     if (leftEdgeCollide || rightEdgeCollide || topEdgeCollide || bottomEdgeCollide)
     {
         if (topEdgeCollide || bottomEdgeCollide || pong->playerWon)
-            PlaySound(pong->beeps[BEEP_EDGE]);
+            PlayBeep(pong->audio, BEEP_EDGE, GetBallBeepPitch(&pong->ball, pong->config));
         else if (leftEdgeCollide || rightEdgeCollide)
-            PlaySound(pong->beeps[BEEP_SCORE]);
+            PlayBeep(pong->audio, BEEP_SCORE, 1.0f);
     }
 }
 
-void BounceBallPaddle(Ball *ball, Paddle *paddle, Sound *beep)
+void BounceBallPaddle(Ball *ball, Paddle *paddle, PongRng *rng, PongAudio *audio, const PongConfig *config)
 {
-    if (CheckCollisionBallPaddle(*ball, *paddle) == false)
+    if (CheckCollisionBallPaddle(ball, paddle) == false)
         return;
 
+    HitBallPaddle(ball, paddle, rng, audio, config);
+}
+
+void HitBallPaddle(Ball *ball, Paddle *paddle, PongRng *rng, PongAudio *audio, const PongConfig *config)
+{
+    const PongConfig *rules = PONG_CONFIG(config);
     bool ballMovingLeft = ball->direction.x < 0;
     // Position the ball outside the paddle
     if (ballMovingLeft)
@@ -216,25 +340,34 @@ void BounceBallPaddle(Ball *ball, Paddle *paddle, Sound *beep)
     }
 
     // Set a new hit position for the potential computer paddle
-    paddle->nextHitPos = (float)GetRandomValue(0, paddle->length/2);
+    // Keep the whole ball on the paddle, so the edge is half a ball in from the end
+    int edgeHitPos = (paddle->length - ball->size) / 2;
+    if (paddle->ai.hitStrategy == HIT_CENTER)
+        paddle->nextHitPos = 0.0f;
+    else if (paddle->ai.hitStrategy == HIT_EDGE)
+        paddle->nextHitPos = (float)(GetPongRngValue(rng, 0, 1) ? edgeHitPos : -edgeHitPos);
+    else
+        paddle->nextHitPos = (float)GetPongRngValue(rng, -edgeHitPos, edgeHitPos);
+    ball->paddleHits++;
+    ball->trajectoryId++; // computer paddles need a new prediction
 
     // Increase ball speed
-    ball->speed *= BOUNCE_MULTIPLIER;
+    ball->speed *= rules->bounceMultiplier;
 
     // Modify the ball's angle based on where it hit the paddle
     float paddleCenter = paddle->position.y + paddle->length / 2.0f;
     float ballCenter = ball->position.y + ball->size / 2.0f;
     float hitPosition = (ballCenter - paddleCenter) / (paddle->length / 2.0f); // -1 to 1
-    float newAngle = hitPosition * PADDLE_HIT_MAX_ANGLE * (PI / 180.0f);
+    Vector2 newDirection = GetPaddleHitDirection(hitPosition, rules);
 
     // Apply new direction
-    ball->direction.y = sinf(newAngle);
-    ball->direction.x = (ballMovingLeft) ? cosf(newAngle) : -cosf(newAngle);
+    ball->direction.y = newDirection.y;
+    ball->direction.x = (ballMovingLeft) ? newDirection.x : -newDirection.x;
 
-    PlaySound(*beep);
+    PlayBeep(audio, BEEP_PADDLE, GetBallBeepPitch(ball, config));
 }
 
-void UpdatePongFrame(GameState *pong, UiState *titleMenu)
+void UpdatePongFrame(GameState *pong, UiState *titleMenu, PongInput *input, PongReplay *replay, PongNetplay *netplay, PongRewind *rewind, int stepCount)
 {
     // Input to go back to title screen
     if (IsKeyPressed(KEY_ESCAPE) || IsKeyPressed(KEY_BACKSPACE) || IsMouseButtonPressed(MOUSE_BUTTON_RIGHT) ||
@@ -242,14 +375,70 @@ void UpdatePongFrame(GameState *pong, UiState *titleMenu)
                                             IsKeyPressed(KEY_ENTER) ||
                                             IsGestureDetected(GESTURE_TAP))))
     {
-        *titleMenu = InitUiState();
-        *pong = InitGameState();
-        pong->currentScreen = SCREEN_TITLE;
+        ReturnToTitle(pong, titleMenu, input);
         return; // back to main game loop
     }
 
+    ReadPongInput(input);
+
+    // Online games are stepped by the netplay, which may rewind a few steps first
+    if (netplay->mode != NETPLAY_OFF)
+    {
+        PollNetplay(netplay, pong, GetTime());
+        if (netplay->mode == NETPLAY_OFF)
+        {
+            ReturnToTitle(pong, titleMenu, input); // the other player went quiet
+            return;
+        }
+        for (int i = 0; i < stepCount; i++)
+        {
+            if (StepNetplay(netplay, pong, input))
+                ClearPongInputPresses(input); // otherwise it's waiting, so keep them for the next step
+        }
+        SendNetplayInputs(netplay, GetTime());
+        return;
+    }
+
+    // Hold R to scrub back through the match, replays have to play every step
+    if (IsKeyDown(KEY_R) && replay->mode == REPLAY_OFF)
+    {
+        RewindPong(rewind, pong, stepCount);
+        ClearPongInputPresses(input);
+        return;
+    }
+
+    // The game runs at a fixed rate, so this frame may need zero or several steps
+    for (int i = 0; i < stepCount; i++)
+    {
+        if (replay->mode == REPLAY_PLAYING && !PlayReplayTick(replay, input))
+        {
+            ReturnToTitle(pong, titleMenu, input); // Replay is over
+            return;
+        }
+        if (replay->mode == REPLAY_RECORDING)
+            RecordReplayTick(replay, input);
+
+        StepPong(pong, input, SIM_TIMESTEP);
+        ClearPongInputPresses(input);
+        if (replay->mode == REPLAY_OFF)
+            RecordRewindTick(rewind, pong);
+    }
+}
+
+void ReturnToTitle(GameState *pong, UiState *titleMenu, PongInput *input)
+{
+    *titleMenu = InitUiState();
+    *pong = InitGameState(NextPongRng(&pong->rng), pong->audio, pong->config);
+    *input = (PongInput){ 0 };
+    pong->currentScreen = SCREEN_TITLE;
+}
+
+void StepPong(GameState *pong, const PongInput *input, float deltaTime)
+{
+    const PongConfig *rules = PONG_CONFIG(pong->config);
+
     // Press Space or P to pause
-    if (IsKeyPressed(KEY_SPACE) || IsKeyPressed(KEY_P))
+    if (input->pausePressed)
     {
         pong->isPaused = !pong->isPaused;
     }
@@ -259,65 +448,70 @@ void UpdatePongFrame(GameState *pong, UiState *titleMenu)
         // Update paddles
         if (pong->currentMode == MODE_1PLAYER)
         {
-            UpdatePaddlePlayer1(&pong->paddleL);
-            UpdatePaddleMouseInput(&pong->paddleL);
-            UpdatePaddleComputer(&pong->paddleR, pong);
+            UpdatePaddlePlayer(&pong->paddleL, input->moveL, deltaTime, pong->config);
+            UpdatePaddleMouseInput(&pong->paddleL, input);
+            UpdatePaddleComputer(&pong->paddleR, &pong->ball, &pong->rng, pong->config, deltaTime);
         }
         if (pong->currentMode == MODE_2PLAYER)
         {
-            UpdatePaddlePlayer1(&pong->paddleL);
-            UpdatePaddlePlayer2(&pong->paddleR);
+            UpdatePaddlePlayer(&pong->paddleL, input->moveL, deltaTime, pong->config);
+            UpdatePaddlePlayer(&pong->paddleR, input->moveR, deltaTime, pong->config);
         }
         if (pong->currentMode == MODE_DEMO)
         {
-            UpdatePaddleComputer(&pong->paddleL, pong);
-            UpdatePaddleComputer(&pong->paddleR, pong);
+            UpdatePaddleComputer(&pong->paddleL, &pong->ball, &pong->rng, pong->config, deltaTime);
+            UpdatePaddleComputer(&pong->paddleR, &pong->ball, &pong->rng, pong->config, deltaTime);
         }
 
         // Update ball
-        if (pong->playerWon && (pong->ball.speed < BALL_SPEED * 4))
-            pong->ball.speed = BALL_SPEED * 4;
+        if (pong->playerWon && (pong->ball.speed < rules->ballSpeed * 4))
+            pong->ball.speed = rules->ballSpeed * 4;
+
+        // Collision logic
+        // A paddle may have moved onto the ball, which the sweep can't see
+        if (pong->playerWon == false)
+        {
+            BounceBallPaddle(&pong->ball, &pong->paddleL, &pong->rng, pong->audio, pong->config);
+            BounceBallPaddle(&pong->ball, &pong->paddleR, &pong->rng, pong->audio, pong->config);
+        }
 
         if (pong->scoreTimer <= 0 ||
-            pong->scoreR == WIN_SCORE || pong->scoreL == WIN_SCORE)
-            UpdateBall(&pong->ball);
+            pong->scoreR == rules->winScore || pong->scoreL == rules->winScore)
+            MoveBall(pong, deltaTime);
 
-        // Collision logic
-        BounceBallEdge(pong);
+        // Or the ball clipped the top or bottom end of a paddle on the way
         if (pong->playerWon == false)
         {
-            BounceBallPaddle(&pong->ball, &pong->paddleL, &pong->beeps[BEEP_PADDLE]);
-            BounceBallPaddle(&pong->ball, &pong->paddleR, &pong->beeps[BEEP_PADDLE]);
+            BounceBallPaddle(&pong->ball, &pong->paddleL, &pong->rng, pong->audio, pong->config);
+            BounceBallPaddle(&pong->ball, &pong->paddleR, &pong->rng, pong->audio, pong->config);
         }
         EdgeCollisionPaddle(&pong->paddleL);
         EdgeCollisionPaddle(&pong->paddleR);
 
         // Check for winner
-        if (pong->scoreL >= WIN_SCORE || pong->scoreR >= WIN_SCORE)
+        if (pong->scoreL >= rules->winScore || pong->scoreR >= rules->winScore)
             pong->playerWon = true;
 
         // Press Enter or Space or Click to skip win screen
-        if (pong->playerWon == true &&
-            (IsKeyPressed(KEY_ENTER) || IsKeyPressed(KEY_SPACE) || IsGestureDetected(GESTURE_TAP)))
+        if (pong->playerWon == true && input->skipPressed)
             pong->winTimer = 0;
 
         // Update timers for winning and scoring
         if (pong->scoreTimer > 0)
-            pong->scoreTimer -= GetFrameTime();
+            pong->scoreTimer -= deltaTime;
         if (pong->playerWon && pong->winTimer > 0)
-            pong->winTimer -= GetFrameTime();
+            pong->winTimer -= deltaTime;
     }
 
     // Update pause fade animation
-    static float fadeLength = 1.5f; // Fade in and out at this rate in seconds
-    static bool fadingOut = false;
-    float fadeIncrement = (1.0f / fadeLength) * GetFrameTime();
+    const float fadeLength = 1.5f; // Fade in and out at this rate in seconds
+    float fadeIncrement = (1.0f / fadeLength) * deltaTime;
 
     if (pong->textFade >= 1.0f)
-        fadingOut = true;
+        pong->textFadingOut = true;
     else if (pong->textFade <= 0.0f)
-        fadingOut = false;
-    if (fadingOut)
+        pong->textFadingOut = false;
+    if (pong->textFadingOut)
         fadeIncrement *= -1;
 
     pong->textFade += fadeIncrement;
@@ -325,68 +519,91 @@ void UpdatePongFrame(GameState *pong, UiState *titleMenu)
     // Reset game after a player wins
     if (pong->playerWon == true && pong->winTimer <= 0)
     {
+        GameMode prevMode = pong->currentMode;
+        ComputerAi prevAiL = pong->paddleL.ai;
+        ComputerAi prevAiR = pong->paddleR.ai;
         GameDifficulty prevDifficulty = pong->difficulty;
-        *pong = InitGameState();
+        *pong = InitGameState(NextPongRng(&pong->rng), pong->audio, pong->config); // next match's seed comes from this one
         pong->currentScreen = SCREEN_GAMEPLAY;
+        pong->currentMode = prevMode;
         pong->difficulty = prevDifficulty;
+        pong->paddleL.ai = prevAiL;
+        pong->paddleR.ai = prevAiR;
     }
+}
 
-    // Debug: Press R to reset ball
-    // if (IsKeyPressed(KEY_R))
-    // {
-    //     ResetBall(&pong.ball);
-    // }
+void ReadPongInput(PongInput *input)
+{
+    input->moveL = ReadPaddlePlayer1();
+    input->moveR = ReadPaddlePlayer2();
+
+    Vector2 scaleFactor = { (float)RENDER_WIDTH / GetScreenWidth(),
+                            (float)RENDER_HEIGHT / GetScreenHeight() };
+    input->mouseY = floorf(GetMousePosition().y * scaleFactor.y); // whole pixels, so replays store it exactly
+
+    // Presses are kept until a step uses them, in case this frame has no steps
+    if (Vector2Length(GetMouseDelta()) > 0)
+        input->mouseMoved = true;
+    if (IsKeyPressed(KEY_SPACE) || IsKeyPressed(KEY_P))
+        input->pausePressed = true;
+    if (IsKeyPressed(KEY_ENTER) || IsKeyPressed(KEY_SPACE) || IsGestureDetected(GESTURE_TAP))
+        input->skipPressed = true;
 }
 
-void UpdatePaddlePlayer1(Paddle *paddle)
+void ClearPongInputPresses(PongInput *input)
 {
-    float newSpeed = 0.0f; // Not moving by default
+    input->mouseMoved = false;
+    input->pausePressed = false;
+    input->skipPressed = false;
+}
+
+float ReadPaddlePlayer1(void)
+{
+    float move = 0.0f; // Not moving by default
 
     // W/S to move paddle
     if (IsKeyDown(KEY_W))
-        newSpeed = -PADDLE_SPEED;
+        move = -1.0f;
     if (IsKeyDown(KEY_S))
-        newSpeed = PADDLE_SPEED;
+        move = 1.0f;
 
     // Left Shift and A/D to speed up
     if (IsKeyDown(KEY_LEFT_SHIFT) || IsKeyDown(KEY_A) || IsKeyDown(KEY_D))
-        newSpeed *= 2;
+        move *= 2;
 
-    // Update paddle
-    paddle->speed = newSpeed;
-    paddle->position.y += paddle->speed * GetFrameTime();
+    return move;
 }
 
-void UpdatePaddlePlayer2(Paddle *paddle)
+float ReadPaddlePlayer2(void)
 {
-    float newSpeed = 0.0f; // Not moving by default
+    float move = 0.0f; // Not moving by default
 
     // I/K or Up/Down arrow keys to move paddle
     if (IsKeyDown(KEY_I) || IsKeyDown(KEY_UP))
-        newSpeed = -PADDLE_SPEED;
+        move = -1.0f;
     if (IsKeyDown(KEY_K) || IsKeyDown(KEY_DOWN))
-        newSpeed = PADDLE_SPEED;
+        move = 1.0f;
 
     // Left/Right arrow keys, or J/L to speed up
     if (IsKeyDown(KEY_J) || IsKeyDown(KEY_L) ||
         IsKeyDown(KEY_LEFT) || IsKeyDown(KEY_RIGHT))
-        newSpeed *= 2;
+        move *= 2;
 
-    // Update paddle
-    paddle->speed = newSpeed;
-    paddle->position.y += paddle->speed * GetFrameTime();
+    return move;
 }
 
-void UpdatePaddleMouseInput(Paddle *paddle)
+void UpdatePaddlePlayer(Paddle *paddle, float move, float deltaTime, const PongConfig *config)
 {
-    Vector2 scaleFactor = { (float)RENDER_WIDTH / GetScreenWidth(),
-                            (float)RENDER_HEIGHT / GetScreenHeight() };
-    Vector2 mousePos = Vector2Multiply(GetMousePosition(), scaleFactor);
+    paddle->speed = move * PONG_CONFIG(config)->paddleSpeed;
+    paddle->position.y += paddle->speed * deltaTime;
+}
 
+void UpdatePaddleMouseInput(Paddle *paddle, const PongInput *input)
+{
     // Only move if the mouse moved and if no keyboard input was detected
-    if (Vector2Length(GetMouseDelta()) > 0 && paddle->speed == 0)
+    if (input->mouseMoved && paddle->speed == 0)
     {
-        paddle->position.y = mousePos.y - paddle->length / 2;
+        paddle->position.y = input->mouseY - paddle->length / 2;
 
         // float distBetweenMousePaddle = fabsf(scaledMousePos.x - paddle->position.x);
         // if (distBetweenMousePaddle < RENDER_WIDTH / 2)
@@ -396,119 +613,281 @@ void UpdatePaddleMouseInput(Paddle *paddle)
     }
 }
 
-void UpdatePaddleComputer(Paddle *paddle, GameState *pong)
+void UpdatePaddleComputer(Paddle *paddle, const Ball *ball, PongRng *rng, const PongConfig *config, float deltaTime)
 {
-    float newSpeed = 0.0f; // Not moving by default
     bool paddleIsLeft = paddle->position.x < RENDER_WIDTH / 2;
-    // Follow the ball
-    if ((paddle->position.y + paddle->nextHitPos) > pong->ball.position.y + pong->ball.size)
-        newSpeed = -PADDLE_SPEED;
-    if ((paddle->position.y + paddle->length - paddle->nextHitPos) < pong->ball.position.y)
-        newSpeed = PADDLE_SPEED;
-
-    // Update Paddle
-    bool ballMovingLeft = pong->ball.direction.x < 0;
-    bool movingTowardsPaddle = ((paddleIsLeft && ballMovingLeft) ||
-                                (!paddleIsLeft && !ballMovingLeft));
-    float distanceToBall = fabsf(paddle->position.x - pong->ball.position.x);
-    float ballIsHalfway = (float)(distanceToBall < RENDER_WIDTH/2 - pong->ball.size*2);
+    bool ballMovingLeft = ball->direction.x < 0;
+    bool movingTowardsPaddle = (paddleIsLeft == ballMovingLeft);
 
-    if (ballIsHalfway)
+    // Predict where the ball will be only once per serve or paddle hit,
+    // since bounces off the top and bottom don't change the prediction
+    if (paddle->predictionId != ball->trajectoryId)
     {
-        GameDifficulty diff = pong->difficulty;
-        paddle->speed = newSpeed * (diff + 1);
+        paddle->predictionId = ball->trajectoryId;
+        paddle->reactionTimer = paddle->ai.reactionDelay;
+
+        if (movingTowardsPaddle)
+        {
+            // Where the front of the ball meets the front of the paddle
+            float targetX = paddleIsLeft ? paddle->position.x + paddle->width :
+                                           paddle->position.x - ball->size;
+            float aimError = (float)GetPongRngValue(rng, -(int)paddle->ai.aimError, (int)paddle->ai.aimError);
+            paddle->nextTargetY = PredictBallY(ball, targetX, config) + ball->size / 2.0f + aimError;
+        }
+        else
+            paddle->nextTargetY = RENDER_HEIGHT / 2.0f; // Wait in the middle
+    }
 
-        // Tweak/adjust diff speeds
-        if (diff == DIFFICULTY_EASY)
-            paddle->speed += paddle->speed * 0.30f;
-        // else if (diff == DIFFICULTY_MEDIUM)
-        //     paddle->speed = paddle->speed * 0.05f;
-        else if (diff == DIFFICULTY_HARD)
-            paddle->speed -= paddle->speed * 0.10f;
+    // Keep doing the same thing until the computer "notices" the new path
+    if (paddle->reactionTimer > 0)
+        paddle->reactionTimer -= deltaTime;
+    else
+        paddle->targetY = paddle->nextTargetY;
 
-        // Move slower after hitting ball
-        if (!movingTowardsPaddle && (distanceToBall < RENDER_WIDTH / 8))
-            paddle->speed /= 3;
+    // Move the chosen hit position on the paddle towards the target
+    float maxSpeed = paddle->ai.speed;
+    if (!movingTowardsPaddle)
+        maxSpeed /= paddle->ai.slowdownAfterHit; // Move slower after hitting ball
 
-        // if (pong->scoreTimer <= 0)
-        paddle->position.y += paddle->speed * GetFrameTime();
+    float hitPointY = paddle->position.y + paddle->length / 2.0f + paddle->nextHitPos;
+    float distance = paddle->targetY - hitPointY;
+    float maxMove = maxSpeed * deltaTime;
+    if (fabsf(distance) <= maxMove)
+    {
+        paddle->position.y += distance;
+        paddle->speed = 0.0f;
+    }
+    else
+    {
+        paddle->speed = (distance > 0) ? maxSpeed : -maxSpeed;
+        paddle->position.y += paddle->speed * deltaTime;
     }
 
     // // Perfect computer
-    // paddle->position.y = pong->ball.position.y;
-
-    // TODO: make computer behavior more interesting/varied
+    // paddle->position.y = ball->position.y;
 }
 
-void UpdateBall(Ball *ball)
+Vector2 GetBallVelocity(const Ball *ball, const PongConfig *config)
 {
+    Vector2 direction = ball->direction;
+
     // Set minimum vertical angle for ball
-    float speed = Vector2Length(ball->direction);
-    float angleRad = MINIMUM_VERTICAL_ANGLE * (PI / 180.0f);
-    float minX = speed * sinf(angleRad);
+    float speed = Vector2Length(direction);
+    float minX = speed * PONG_CONFIG(config)->minimumVerticalSin;
 
-    if (fabsf(ball->direction.x) < minX)
+    if (fabsf(direction.x) < minX)
     {
-        ball->direction.x = (ball->direction.x >= 0) ? minX : -minX;
+        direction.x = (direction.x >= 0) ? minX : -minX;
         // Recalculate y to preserve speed
-        ball->direction.y = (ball->direction.y >= 0) ?
-            sqrtf(speed*speed - ball->direction.x * ball->direction.x) :
-            -sqrtf(speed*speed - ball->direction.x * ball->direction.x);
+        direction.y = (direction.y >= 0) ?
+            sqrtf(speed*speed - direction.x * direction.x) :
+            -sqrtf(speed*speed - direction.x * direction.x);
     }
 
     // Normalize direction's speed
-    ball->direction = Vector2Scale(Vector2Normalize(ball->direction), ball->speed);
+    return Vector2Scale(Vector2Normalize(direction), ball->speed);
+}
+
+float GetBallBeepPitch(const Ball *ball, const PongConfig *config)
+{
+    // Square root so a long rally climbs about an octave instead of shooting off
+    // PlayBeep() clamps it, slow balls from a custom config included
+    return sqrtf(ball->speed / PONG_CONFIG(config)->ballSpeed);
+}
+
+void UpdateBall(Ball *ball, float deltaTime, const PongConfig *config)
+{
+    ball->direction = GetBallVelocity(ball, config);
 
     // Update ball's position based on direction
-    Vector2 deltaTimeSpeed = Vector2Scale(ball->direction, GetFrameTime());
+    Vector2 deltaTimeSpeed = Vector2Scale(ball->direction, deltaTime);
     ball->position = Vector2Add(ball->position, deltaTimeSpeed);
 }
 
-void DrawPongFrame(GameState *pong, UiState *ui)
+void MoveBall(GameState *pong, float deltaTime)
 {
-    // Draw dotted line down middle
-    DrawFieldLines(pong->isPaused, pong->currentMode == MODE_DEMO);
+    Ball *ball = &pong->ball;
+    float timeLeft = deltaTime;
 
-    // Draw ball
-    if (pong->scoreTimer <= 0 || pong->scoreR == WIN_SCORE || pong->scoreL == WIN_SCORE)
-        DrawRectangle((int)pong->ball.position.x, (int)pong->ball.position.y,
-                      (int)pong->ball.size,       (int)pong->ball.size, RAYWHITE);
+    // Move to the first thing the ball touches, bounce, then carry on with the
+    // time that's left, so a fast ball or a long step can't skip through anything
+    for (int i = 0; i < SIM_MAX_BALL_BOUNCES && timeLeft > 0.0f; i++)
+    {
+        ball->direction = GetBallVelocity(ball, pong->config);
+        Vector2 velocity = ball->direction;
 
+        float hitTime = timeLeft;
+        Paddle *hitPaddle = NULL;
+        bool hitEdge = false;
+        Vector2 edgeContact = { 0 };
 
-    // Draw score
-    DrawScores(pong);
+        float edgeTime = SweepBallEdge(ball, velocity, &edgeContact);
+        if (edgeTime <= hitTime)
+        {
+            hitTime = edgeTime;
+            hitEdge = true;
+        }
+        if (pong->playerWon == false)
+        {
+            Paddle *paddles[2] = { &pong->paddleL, &pong->paddleR };
+            for (int p = 0; p < 2; p++)
+            {
+                float paddleTime = SweepBallPaddle(ball, velocity, paddles[p]);
+                if (paddleTime < hitTime)
+                {
+                    hitTime = paddleTime;
+                    hitPaddle = paddles[p];
+                    hitEdge = false;
+                }
+            }
+        }
+
+        timeLeft -= hitTime;
+
+        if (hitPaddle != NULL)
+        {
+            ball->position = Vector2Add(ball->position, Vector2Scale(velocity, hitTime));
+            HitBallPaddle(ball, hitPaddle, &pong->rng, pong->audio, pong->config);
+        }
+        else if (hitEdge)
+        {
+            ball->position = edgeContact; // Exactly on the edge, so BounceBallEdge() sees it
+            int prevScore = pong->scoreL + pong->scoreR;
+            BounceBallEdge(pong);
+            if (pong->scoreL + pong->scoreR != prevScore)
+                break; // Rest of the step is spent in the score pause
+        }
+        else
+        {
+            ball->position = Vector2Add(ball->position, Vector2Scale(velocity, hitTime));
+            break; // Nothing in the way
+        }
+    }
+}
+
+float SweepBallEdge(const Ball *ball, Vector2 velocity, Vector2 *contact)
+{
+    // The ball's far side is used for the bottom and right edges, same as BounceBallEdge()
+    float edgeX = (velocity.x < 0) ? 0.0f : (float)RENDER_WIDTH - ball->size;
+    float edgeY = (velocity.y < 0) ? (float)FIELD_LINE_WIDTH :
+                                     (float)RENDER_HEIGHT - ball->size - FIELD_LINE_WIDTH;
+
+    // Already touching or past an edge counts as hitting it right away
+    float timeX = (velocity.x != 0.0f) ? fmaxf((edgeX - ball->position.x) / velocity.x, 0.0f) : INFINITY;
+    float timeY = (velocity.y != 0.0f) ? fmaxf((edgeY - ball->position.y) / velocity.y, 0.0f) : INFINITY;
+    float time = fminf(timeX, timeY);
+
+    // Snap the axis that hit, so rounding can't leave the ball a hair short of the edge
+    *contact = Vector2Add(ball->position, Vector2Scale(velocity, time));
+    if (timeX <= timeY)
+        contact->x = edgeX;
+    else
+        contact->y = edgeY;
+
+    return time;
+}
+
+float SweepBallPaddle(const Ball *ball, Vector2 velocity, const Paddle *paddle)
+{
+    // Only the face towards the middle of the field can be swept into,
+    // anything else is left to the overlap test in BounceBallPaddle()
+    bool paddleIsLeft = paddle->position.x < RENDER_WIDTH / 2;
+    float time;
+    if (paddleIsLeft && velocity.x < 0)
+        time = (paddle->position.x + paddle->width - ball->position.x) / velocity.x;
+    else if (!paddleIsLeft && velocity.x > 0)
+        time = (paddle->position.x - (ball->position.x + ball->size)) / velocity.x;
+    else
+        return INFINITY;
+
+    if (time < 0.0f)
+        return INFINITY; // Already past the face
+
+    // Same vertical overlap as CheckCollisionBallPaddle(), at the moment it reaches the face
+    float y = ball->position.y + velocity.y * time;
+    if (y < paddle->position.y + paddle->length && y + ball->size > paddle->position.y)
+        return time;
+
+    return INFINITY;
+}
+
+Vector2 GetPaddleHitDirection(float hitPosition, const PongConfig *config)
+{
+    // The table is only for the default angle, anything else is worked out every time
+    const PongConfig *rules = PONG_CONFIG(config);
+    if (rules->paddleHitMaxAngle != PADDLE_HIT_MAX_ANGLE || fabsf(hitPosition) > PADDLE_HIT_RANGE)
+    {
+        float angle = hitPosition * rules->paddleHitMaxAngle * (PI / 180.0f);
+        return (Vector2){ cosf(angle), sinf(angle) };
+    }
+
+    // Both halves of the paddle are mirror images, so the table only has one
+    float index = fabsf(hitPosition) * (PADDLE_HIT_STEPS / PADDLE_HIT_RANGE) + 0.5f;
+    Vector2 direction = paddleHitDirections[(index < PADDLE_HIT_STEPS) ? (int)index : PADDLE_HIT_STEPS];
+    if (hitPosition < 0.0f)
+        direction.y = -direction.y;
+
+    return direction;
+}
+
+float PredictBallY(const Ball *ball, float targetX, const PongConfig *config)
+{
+    Vector2 velocity = GetBallVelocity(ball, config);
+    if (velocity.x == 0.0f)
+        return ball->position.y;
+
+    float time = (targetX - ball->position.x) / velocity.x;
+    if (time < 0.0f)
+        return ball->position.y; // Already past it
+
+    // Unfold the walls: the ball's path is a straight line through mirrored copies
+    // of the field, so wrap the end point back into the real one
+    float top = FIELD_LINE_WIDTH;
+    float range = (RENDER_HEIGHT - FIELD_LINE_WIDTH - ball->size) - top;
+    float y = fmodf(ball->position.y + velocity.y * time - top, 2.0f * range);
+    if (y < 0.0f)
+        y += 2.0f * range;
+    if (y > range)
+        y = 2.0f * range - y; // Odd number of bounces, so it's mirrored
+
+    return top + y;
+}
+
+void DrawPongFrame(GameState *pong, const Playfield *field)
+{
+    const PongConfig *rules = PONG_CONFIG(pong->config);
+
+    // Draw field lines, with a gap in the dotted line for the pause/demo text
+    DrawPlayfield(field, pong->isPaused || pong->currentMode == MODE_DEMO);
 
-    // Draw paddles
+    // Ball and paddles all go out in one batch
+    Rectangle quads[3];
+    int quadCount = 0;
+    if (pong->scoreTimer <= 0 || pong->scoreR == rules->winScore || pong->scoreL == rules->winScore)
+        quads[quadCount++] = (Rectangle){ (float)(int)pong->ball.position.x, (float)(int)pong->ball.position.y,
+                                          (float)(int)pong->ball.size,       (float)(int)pong->ball.size };
     if (pong->playerWon == false)
     {
-        DrawRectangle((int)pong->paddleR.position.x, (int)pong->paddleR.position.y,
-                      (int)pong->paddleR.width,      (int)pong->paddleR.length, RAYWHITE);
-        DrawRectangle((int)pong->paddleL.position.x, (int)pong->paddleL.position.y,
-                      (int)pong->paddleL.width,      (int)pong->paddleL.length, RAYWHITE);
+        quads[quadCount++] = (Rectangle){ (float)(int)pong->paddleR.position.x, (float)(int)pong->paddleR.position.y,
+                                          (float)pong->paddleR.width,           (float)pong->paddleR.length };
+        quads[quadCount++] = (Rectangle){ (float)(int)pong->paddleL.position.x, (float)(int)pong->paddleL.position.y,
+                                          (float)pong->paddleL.width,           (float)pong->paddleL.length };
     }
+    DrawQuadBatch(quads, quadCount, RAYWHITE);
+
+    // Draw score
+    DrawScores(pong);
 
     // Draw difficulty mode text in lower right
     if (pong->currentMode == MODE_1PLAYER)
     {
-        const char *difficultyText;
-        int diffTextLength;
-        switch (pong->difficulty)
-        {
-            case DIFFICULTY_EASY:
-                difficultyText = "Difficulty Easy";
-                break;
-            case DIFFICULTY_MEDIUM:
-                difficultyText = "Difficulty Medium";
-                break;
-            case DIFFICULTY_HARD:
-                difficultyText = "Difficulty Hard";
-                break;
-        }
-        diffTextLength = MeasureText(difficultyText, DIFFICULTY_FONT_SIZE);
-        DrawText(difficultyText,
-                 RENDER_WIDTH / 4 * 3 - diffTextLength / 2,
-                 RENDER_HEIGHT - (DIFFICULTY_FONT_SIZE * 2),
-                 DIFFICULTY_FONT_SIZE, RAYWHITE);
+        static const char *difficultyTexts[] = { "Difficulty Easy", "Difficulty Medium", "Difficulty Hard" };
+        const char *difficultyText = difficultyTexts[pong->difficulty];
+        int diffTextLength = MeasureTextCached(difficultyText, DIFFICULTY_FONT_SIZE);
+        RenderText(difficultyText,
+                   RENDER_WIDTH / 4 * 3 - diffTextLength / 2,
+                   RENDER_HEIGHT - (DIFFICULTY_FONT_SIZE * 2),
+                   DIFFICULTY_FONT_SIZE, RAYWHITE);
     }
 
     // Draw fancy conditional text with a fade animation
@@ -516,38 +895,119 @@ void DrawPongFrame(GameState *pong, UiState *ui)
 
     // Draw win message
     if (pong->playerWon)
-        DrawWinnerMessage(pong->scoreL, pong->scoreR, fadeColor);
+        DrawWinnerMessage(pong->scoreL, pong->scoreR, rules->winScore, fadeColor);
 
     // Draw pause message
     char *text;
     if (pong->isPaused)
     {
         text = "PAUSED";
-        int textOffset = MeasureText(text, SCORE_FONT_SIZE) / 2;
-        DrawText(text, RENDER_WIDTH / 2 - textOffset,
-                 RENDER_HEIGHT / 2 - SCORE_FONT_SIZE / 2,
-                 SCORE_FONT_SIZE, fadeColor);
+        int textOffset = MeasureTextCached(text, SCORE_FONT_SIZE) / 2;
+        RenderText(text, RENDER_WIDTH / 2 - textOffset,
+                   RENDER_HEIGHT / 2 - SCORE_FONT_SIZE / 2,
+                   SCORE_FONT_SIZE, fadeColor);
     }
     else if (pong->currentMode == MODE_DEMO) // Draw demo mode message
     {
         text = "DEMO MODE";
-        int textOffset = MeasureText(text, SCORE_FONT_SIZE) / 2;
-        DrawText(text, RENDER_WIDTH / 2 - textOffset,
-                 RENDER_HEIGHT / 2 - SCORE_FONT_SIZE / 2,
-                 SCORE_FONT_SIZE, fadeColor);
+        int textOffset = MeasureTextCached(text, SCORE_FONT_SIZE) / 2;
+        RenderText(text, RENDER_WIDTH / 2 - textOffset,
+                   RENDER_HEIGHT / 2 - SCORE_FONT_SIZE / 2,
+                   SCORE_FONT_SIZE, fadeColor);
     }
 }
 
+Playfield LoadPlayfield(void)
+{
+    Playfield field = { 0 };
+    field.plain = LoadRenderTexture(RENDER_WIDTH, RENDER_HEIGHT);
+    field.textGap = LoadRenderTexture(RENDER_WIDTH, RENDER_HEIGHT);
+
+    BeginTextureMode(field.plain);
+    {
+        ClearBackground(BLANK);
+        DrawFieldLines(false, false);
+    } EndTextureMode();
+
+    BeginTextureMode(field.textGap);
+    {
+        ClearBackground(BLANK);
+        DrawFieldLines(true, false);
+    } EndTextureMode();
+
+    return field;
+}
+
+void UnloadPlayfield(Playfield *field)
+{
+    UnloadRenderTexture(field->plain);
+    UnloadRenderTexture(field->textGap);
+}
+
+void DrawPlayfield(const Playfield *field, bool hasTextGap)
+{
+    // The canvas is cheap to draw lines on, and has no textures
+    if (GetRenderCanvas() != NULL)
+    {
+        DrawFieldLines(hasTextGap, false);
+        return;
+    }
+
+    const RenderTexture2D *target = hasTextGap ? &field->textGap : &field->plain;
+    // Render textures are upside down
+    DrawTextureRec(target->texture, (Rectangle){ 0.0f, 0.0f, (float)target->texture.width, (float)-target->texture.height },
+                   (Vector2){ 0.0f, 0.0f }, WHITE);
+}
+
+void DrawQuadBatch(const Rectangle *rects, int count, Color color)
+{
+    if (GetRenderCanvas() != NULL)
+    {
+        for (int i = 0; i < count; i++)
+            RenderRectangle((int)rects[i].x, (int)rects[i].y, (int)rects[i].width, (int)rects[i].height, color);
+        return;
+    }
+
+    // The same vertices DrawRectangleRec() makes, but in one rlBegin()/rlEnd()
+    Texture2D shapes = GetShapesTexture();
+    Rectangle source = GetShapesTextureRectangle();
+    float left = source.x / shapes.width;
+    float top = source.y / shapes.height;
+    float right = (source.x + source.width) / shapes.width;
+    float bottom = (source.y + source.height) / shapes.height;
+
+    rlSetTexture(shapes.id);
+    rlBegin(RL_QUADS);
+    {
+        rlNormal3f(0.0f, 0.0f, 1.0f);
+        rlColor4ub(color.r, color.g, color.b, color.a);
+
+        for (int i = 0; i < count; i++)
+        {
+            Rectangle rect = rects[i];
+            rlTexCoord2f(left, top);
+            rlVertex2f(rect.x, rect.y);
+            rlTexCoord2f(left, bottom);
+            rlVertex2f(rect.x, rect.y + rect.height);
+            rlTexCoord2f(right, bottom);
+            rlVertex2f(rect.x + rect.width, rect.y + rect.height);
+            rlTexCoord2f(right, top);
+            rlVertex2f(rect.x + rect.width, rect.y);
+        }
+    } rlEnd();
+    rlSetTexture(0);
+}
+
 void DrawFieldLines(bool isPaused, bool isDemoMode)
 {
     int dashHeight = 40;
     int spaceHeight = 40;
 
     // Draw top and bottom lines
-    DrawRectangle(0, 0,
-                  RENDER_WIDTH, FIELD_LINE_WIDTH, RAYWHITE);
-    DrawRectangle(0, RENDER_HEIGHT - FIELD_LINE_WIDTH,
-                  RENDER_WIDTH, FIELD_LINE_WIDTH, RAYWHITE);
+    RenderRectangle(0, 0,
+                    RENDER_WIDTH, FIELD_LINE_WIDTH, RAYWHITE);
+    RenderRectangle(0, RENDER_HEIGHT - FIELD_LINE_WIDTH,
+                    RENDER_WIDTH, FIELD_LINE_WIDTH, RAYWHITE);
 
     // Calculate amount of dashes needed for dotted line
     int totalSegmentHeight = dashHeight + spaceHeight;
@@ -569,8 +1029,8 @@ void DrawFieldLines(bool isPaused, bool isDemoMode)
              (y < pauseMessageYPos + SCORE_FONT_SIZE)))
             continue;
 
-        DrawRectangle(RENDER_WIDTH / 2 - FIELD_LINE_WIDTH / 2, y,
-                      FIELD_LINE_WIDTH, dashHeight, RAYWHITE);
+        RenderRectangle(RENDER_WIDTH / 2 - FIELD_LINE_WIDTH / 2, y,
+                        FIELD_LINE_WIDTH, dashHeight, RAYWHITE);
 
     }
 }
@@ -579,48 +1039,61 @@ void DrawScores(GameState *pong)
 {
     int fontSize = 180;
 
-    const char *scoreLMsg = TextFormat("%i", pong->scoreL);
-    int scoreLWidth = MeasureText(scoreLMsg, fontSize);
+    const char *scoreLMsg = GetScoreText(pong->scoreL);
+    int scoreLWidth = MeasureTextCached(scoreLMsg, fontSize);
     int scoreLPosX = RENDER_WIDTH / 4 - scoreLWidth / 2;
 
-    const char *scoreRMsg = TextFormat("%i", pong->scoreR);
-    int scoreRWidth = MeasureText(scoreRMsg, fontSize);
+    const char *scoreRMsg = GetScoreText(pong->scoreR);
+    int scoreRWidth = MeasureTextCached(scoreRMsg, fontSize);
     int scoreRPosX = RENDER_WIDTH / 4 * 3 - scoreRWidth / 2;
 
     int scorePosY = 50;
-    DrawText(scoreLMsg, scoreLPosX, scorePosY, fontSize, RAYWHITE);
-    DrawText(scoreRMsg, scoreRPosX, scorePosY, fontSize, RAYWHITE);
+    RenderText(scoreLMsg, scoreLPosX, scorePosY, fontSize, RAYWHITE);
+    RenderText(scoreRMsg, scoreRPosX, scorePosY, fontSize, RAYWHITE);
 }
 
-void DrawWinnerMessage(int scoreL, int scoreR, Color fadeColor)
+const char *GetScoreText(int score)
+{
+    static const char *scoreTexts[] = { "0", "1", "2", "3", "4", "5", "6", "7", "8", "9",
+                                        "10", "11", "12", "13", "14", "15", "16", "17", "18", "19", "20" };
+    if (score >= 0 && score < (int)ARRAY_SIZE(scoreTexts))
+        return scoreTexts[score];
+
+    return TextFormat("%i", score);
+}
+
+void DrawWinnerMessage(int scoreL, int scoreR, int winScore, Color fadeColor)
 {
     char *msg = "Winner";
     int fontSize = 100; // this is also the font height because we're using the default font
-    int textWidth = MeasureText(msg, fontSize);
+    int textWidth = MeasureTextCached(msg, fontSize);
     int textPosY = (RENDER_HEIGHT - fontSize) / 4;
-    if (scoreL == WIN_SCORE)
+    if (scoreL == winScore)
     {
         int textPosX = RENDER_WIDTH / 4 - textWidth / 2;
-        DrawText(msg, textPosX, textPosY, fontSize, fadeColor);
+        RenderText(msg, textPosX, textPosY, fontSize, fadeColor);
     }
-    if (scoreR == WIN_SCORE)
+    if (scoreR == winScore)
     {
         int textPosX = RENDER_WIDTH / 4 * 3 - textWidth / 2;
-        DrawText(msg, textPosX, textPosY, fontSize, fadeColor);
+        RenderText(msg, textPosX, textPosY, fontSize, fadeColor);
     }
 }
 
-void ResetBall(Ball *ball)
+void ResetBall(Ball *ball, PongRng *rng, const PongConfig *config)
 {
+    const PongConfig *rules = PONG_CONFIG(config);
+
     // Return to center, but keep previous vertical position
     ball->position.x = ((float)RENDER_WIDTH - ball->size) / 2.0f;
 
     // Change the ball's return position and angle a bit
-    ball->position.y += GetRandomValue(-RETURN_POSITION_VARIATION, RETURN_POSITION_VARIATION);
-    ball->direction.y += GetRandomValue(-RETURN_ANGLE_VARIATION, RETURN_ANGLE_VARIATION);
+    ball->position.y += GetPongRngValue(rng, -rules->returnPositionVariation, rules->returnPositionVariation);
+    ball->direction.y += GetPongRngValue(rng, -rules->returnAngleVariation, rules->returnAngleVariation);
     if (ball->position.y <= FIELD_LINE_WIDTH)
         ball->position.y = (float)(FIELD_LINE_WIDTH + ball->size);
     else if (ball->position.y >= RENDER_HEIGHT - FIELD_LINE_WIDTH)
         ball->position.y = (float)(RENDER_HEIGHT - FIELD_LINE_WIDTH - ball->size*2);
-    ball->speed = BALL_SPEED;
+    ball->speed = rules->ballSpeed;
+    ball->trajectoryId++; // computer paddles need a new prediction
 }
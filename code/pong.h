@@ -6,6 +6,10 @@
 
 #include "raylib.h"
 #include "states.h"
+#include "replay.h" // for PongReplay
+#include "netplay.h" // for PongNetplay
+#include "rewind.h" // for PongRewind
+#include "audio.h" // for PlayBeep()
 
 // Macros
 // --------------------------------------------------------------------------------
@@ -23,6 +27,7 @@
 #define PADDLE_HIT_MAX_ANGLE 40.0f   // How much the ball's angle is affected by where it hits the paddle (0 to 90 degrees)
                                      // This is the angle the ball will deflect at if it hits the top or bottom of the paddle
 #define MINIMUM_VERTICAL_ANGLE 25.0f // The minimum vertical angle the ball can move (1 degree minimum)
+#define PADDLE_HIT_STEPS 128         // Hit directions in the table from the paddle's center to past its end, see GetPaddleHitDirection()
 #define RETURN_POSITION_VARIATION 50 // How much the ball's vertical position can change after scoring
 #define RETURN_ANGLE_VARIATION 500   // How much the ball's angle can change after scoring
 
@@ -32,38 +37,89 @@
 #define DIFFICULTY_FONT_SIZE 50 // For text that shows difficulty at bottom of screen
 #define WIN_FONT_SIZE 100
 
+// Sine and cosine as polynomials, so angles from the tweaks above can be turned into
+// constants at compile time. Within float rounding from 0 to 90 degrees (x in radians)
+#define POLY_SIN(x) ((x)*(1.0f - (x)*(x)/6.0f*(1.0f - (x)*(x)/20.0f*(1.0f - (x)*(x)/42.0f*(1.0f - (x)*(x)/72.0f*(1.0f - (x)*(x)/110.0f))))))
+#define POLY_COS(x) (1.0f - (x)*(x)/2.0f*(1.0f - (x)*(x)/12.0f*(1.0f - (x)*(x)/30.0f*(1.0f - (x)*(x)/56.0f*(1.0f - (x)*(x)/90.0f*(1.0f - (x)*(x)/132.0f))))))
+#define MINIMUM_VERTICAL_SIN POLY_SIN(MINIMUM_VERTICAL_ANGLE * (PI / 180.0f))
+
+// Builds with PONG_FIXED_CONFIG (the game itself) always play with the defaults below,
+// so every setting is a constant the compiler can fold. Other builds (the tools)
+// read each match's config, which can be loaded from a file
+#if defined(PONG_FIXED_CONFIG)
+    #define PONG_CONFIG(config) ((void)(config), &defaultPongConfig)
+#else
+    #define PONG_CONFIG(config) (config)
+#endif
+
 #define SCORE_PAUSE_TIME 1.0f  // Time to pause after a score
 #define WIN_PAUSE_TIME 10.0f   // Time to pause after a win
 
+// Fixed timestep simulation
+#define SIM_TICK_RATE 240                  // Game logic updates per second, independent of framerate
+#define SIM_TIMESTEP (1.0f / SIM_TICK_RATE)
+#define SIM_MAX_STEPS_PER_FRAME 24         // Drop time after long hitches instead of spiraling
+#define SIM_MAX_BALL_BOUNCES 8             // Ball collisions handled in one step, the rest of the step is dropped
+
+// Default Config
+// --------------------------------------------------------------------------------
+static const PongConfig defaultPongConfig = { // every setting from the macros above
+    #define PONG_CONFIG_DEFAULT(type, name, defaultValue, lowest, highest) .name = (type)(defaultValue),
+    PONG_CONFIG_FIELDS(PONG_CONFIG_DEFAULT)
+    #undef PONG_CONFIG_DEFAULT
+    .minimumVerticalSin = MINIMUM_VERTICAL_SIN,
+};
+
 // Prototypes
 // --------------------------------------------------------------------------------
 
 // Initialization
-GameState InitGameState(void); // Initialize game objects and data for the game loop
-Sound GenBeep(float freq, float lengthSec);
-void FreeBeeps(GameState *pong);
+GameState InitGameState(unsigned int seed, PongAudio *audio, const PongConfig *config); // Initialize game objects and data for the game loop, audio can be NULL, config NULL for the defaults
+bool LoadPongConfig(PongConfig *config, const char *fileName); // Overrides settings from "name = value" lines, false if the file can't be read
+ComputerAi GetComputerAi(GameDifficulty difficulty, const PongConfig *config); // Default computer tuning for a difficulty, twice as fast as the config's paddles
+void SetGameDifficulty(GameState *pong, GameDifficulty difficulty); // Also retunes both computer paddles
+void StartPongMatch(GameState *pong, GameMode mode, GameDifficulty difficulty, unsigned int seed); // Starts a freshly initialized game, reseeded for replays
+Vector2 GetServeDirection(PongRng *rng); // Random direction for the first serve
 
 // Collision
-bool CheckCollisionBallPaddle(Ball ball, Paddle paddle); // Check if ball and paddle are colliding
+bool CheckCollisionBallPaddle(const Ball *ball, const Paddle *paddle); // Check if ball and paddle are colliding
 void EdgeCollisionPaddle(Paddle *paddle); // Paddles collide with screen edges
 void BounceBallEdge(GameState *pong); // Ball bounces off screen edges and updates the score
-void BounceBallPaddle(Ball *ball, Paddle *paddle, Sound *beep); // Ball bounces off paddle
+void BounceBallPaddle(Ball *ball, Paddle *paddle, PongRng *rng, PongAudio *audio, const PongConfig *config); // Ball bounces off paddle if they overlap
+void HitBallPaddle(Ball *ball, Paddle *paddle, PongRng *rng, PongAudio *audio, const PongConfig *config); // Bounces the ball off the paddle's front, sets its new angle and speed
+float SweepBallEdge(const Ball *ball, Vector2 velocity, Vector2 *contact); // Time until the ball reaches a screen edge, and where it'll be
+float SweepBallPaddle(const Ball *ball, Vector2 velocity, const Paddle *paddle); // Time until the ball hits the paddle's front, INFINITY if it misses
+Vector2 GetPaddleHitDirection(float hitPosition, const PongConfig *config); // Unit direction off a paddle facing right, hitPosition is -1 (top end) to 1 (bottom end)
 
 // Update game
-void UpdatePongFrame(GameState *pong, UiState *titleMenu); // Updates all the game's data and objects for the current frame
-void UpdatePaddleMouseInput(Paddle *paddle); // Updates paddle's position based on the mouse
-void UpdatePaddlePlayer1(Paddle *paddle); // Paddle speed updates based on player input (W/S with Left Shift)
-void UpdatePaddlePlayer2(Paddle *paddle); // Paddle speed updates based on player input (O/L and Up/Down with Right Shift)
-void UpdatePaddleComputer(Paddle *paddle, GameState *pong); // Paddle speed updates based on Computer AI
-void UpdateBall(Ball *ball); // Moves the ball based on its direction, and normalizes its speed
+void UpdatePongFrame(GameState *pong, UiState *titleMenu, PongInput *input, PongReplay *replay, PongNetplay *netplay, PongRewind *rewind, int stepCount); // Reads input and runs this frame's fixed steps, online if netplay is on, backwards if R is held
+void ReturnToTitle(GameState *pong, UiState *titleMenu, PongInput *input); // Resets the game and menu
+void StepPong(GameState *pong, const PongInput *input, float deltaTime); // Advances the game by one step, no window or input needed
+void ReadPongInput(PongInput *input); // Polls keyboard/mouse, pressed buttons stay set until a step uses them
+void ClearPongInputPresses(PongInput *input); // Clears button presses once a step has used them
+float ReadPaddlePlayer1(void); // Paddle movement from player input (W/S with Left Shift)
+float ReadPaddlePlayer2(void); // Paddle movement from player input (I/K and Up/Down with J/L or Left/Right)
+void UpdatePaddleMouseInput(Paddle *paddle, const PongInput *input); // Updates paddle's position based on the mouse
+void UpdatePaddlePlayer(Paddle *paddle, float move, float deltaTime, const PongConfig *config); // Paddle speed updates based on player movement
+void UpdatePaddleComputer(Paddle *paddle, const Ball *ball, PongRng *rng, const PongConfig *config, float deltaTime); // Paddle speed updates based on Computer AI
+void UpdateBall(Ball *ball, float deltaTime, const PongConfig *config); // Moves the ball based on its direction, and normalizes its speed
+void MoveBall(GameState *pong, float deltaTime); // Like UpdateBall(), but sweeps the whole step and bounces off anything in the way
+Vector2 GetBallVelocity(const Ball *ball, const PongConfig *config); // The direction UpdateBall() will move in, with the minimum angle and speed applied
+float GetBallBeepPitch(const Ball *ball, const PongConfig *config); // Bounce beeps go up as the ball speeds up, 1 at the serve speed
 
 // Draw game
-void DrawPongFrame(GameState *pong, UiState *ui); // Draws all the game's objects for the current frame
-void DrawFieldLines(bool isPaused, bool isDemoMode);
+void DrawPongFrame(GameState *pong, const Playfield *field); // Draws all the game's objects for the current frame
+Playfield LoadPlayfield(void); // Needs a window, and has to be called outside of any texture mode
+void UnloadPlayfield(Playfield *field);
+void DrawPlayfield(const Playfield *field, bool hasTextGap);
+void DrawFieldLines(bool isPaused, bool isDemoMode); // Only used to bake the playfield
+void DrawQuadBatch(const Rectangle *rects, int count, Color color); // Same as DrawRectangleRec() for each one, in a single batch
 void DrawScores(GameState *pong);
-void DrawWinnerMessage(int scoreL, int scoreR, Color fadeColor);
+const char *GetScoreText(int score); // Score as text, without formatting a new string every frame
+void DrawWinnerMessage(int scoreL, int scoreR, int winScore, Color fadeColor);
 
 // Game functions
-void ResetBall(Ball *ball); // Reset the ball's horizontal position and modify its vertical position and angle
+void ResetBall(Ball *ball, PongRng *rng, const PongConfig *config); // Reset the ball's horizontal position and modify its vertical position and angle
+float PredictBallY(const Ball *ball, float targetX, const PongConfig *config); // Height the ball will be at when it reaches targetX, including wall bounces
 
 #endif // PONG_GAME_HEADER_GUARD
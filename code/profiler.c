@@ -0,0 +1,214 @@
+// EXPLANATION:
+// Measures how long each part of a frame takes, and shows it in an overlay
+// See profiler.h for more documentation/descriptions
+
+#include "profiler.h"
+
+#include <stdio.h>  // for writing the CSV file
+#include <stdlib.h> // for qsort()
+#include <string.h> // for memset()
+
+#include "config.h" // for MAX_FRAMERATE
+
+// Macros
+// --------------------------------------------------------------------------------
+#define OVERLAY_FONT_SIZE 20
+#define OVERLAY_MARGIN 10
+#define OVERLAY_GRAPH_FRAMES 256 // Newest frames shown in the graph, one pixel each
+#define OVERLAY_GRAPH_HEIGHT 100
+#define OVERLAY_GRAPH_MAX_MS 25.0f // Frame time at the top of the graph
+#define OVERLAY_WIDTH (OVERLAY_GRAPH_FRAMES + 2 * OVERLAY_MARGIN + 160)
+
+// Local Variables Definition
+// --------------------------------------------------------------------------------
+static const char *zoneNames[ZONE_COUNT] = { "update", "draw", "blit", "present", "frame" };
+
+// Local Functions Declaration
+// --------------------------------------------------------------------------------
+static unsigned int GetRecordedFrames(const Profiler *profiler); // Complete frames still in the history
+static int CompareFloats(const void *a, const void *b);
+static void UpdateProfileStats(Profiler *profiler); // Percentiles over the whole history
+
+Profiler InitProfiler(void)
+{
+    Profiler profiler = { 0 };
+    profiler.showOverlay = false;
+    return profiler;
+}
+
+void BeginProfileFrame(Profiler *profiler)
+{
+    double now = GetTime();
+
+    // Finish the previous frame, its slot is complete now
+    if (profiler->zoneStart[ZONE_FRAME] > 0.0)
+    {
+        unsigned int slot = profiler->frameCount % PROFILER_HISTORY;
+        profiler->history[slot][ZONE_FRAME] = (float)((now - profiler->zoneStart[ZONE_FRAME]) * 1000.0);
+        profiler->frameCount++;
+    }
+    profiler->zoneStart[ZONE_FRAME] = now;
+    memset(profiler->history[profiler->frameCount % PROFILER_HISTORY], 0, sizeof(profiler->history[0]));
+
+    if (IsKeyPressed(PROFILER_TOGGLE_KEY))
+    {
+        profiler->showOverlay = !profiler->showOverlay;
+        profiler->framesUntilStats = 0;
+    }
+    if (IsKeyPressed(PROFILER_SAVE_KEY))
+    {
+        const char *fileName = TextFormat("profile_%i.csv", profiler->savedCount++);
+        if (SaveProfilerCsv(profiler, fileName))
+            TraceLog(LOG_INFO, "PROFILER: Saved frame times to %s", fileName);
+    }
+}
+
+void BeginProfileZone(Profiler *profiler, ProfileZone zone)
+{
+    profiler->zoneStart[zone] = GetTime();
+}
+
+void EndProfileZone(Profiler *profiler, ProfileZone zone)
+{
+    unsigned int slot = profiler->frameCount % PROFILER_HISTORY;
+    profiler->history[slot][zone] += (float)((GetTime() - profiler->zoneStart[zone]) * 1000.0);
+}
+
+void DrawProfilerOverlay(Profiler *profiler)
+{
+    if (!profiler->showOverlay)
+        return;
+
+    // Sorting the whole history is cheap, but not free, so don't do it every frame
+    if (--profiler->framesUntilStats <= 0)
+    {
+        UpdateProfileStats(profiler);
+        profiler->framesUntilStats = PROFILER_STATS_INTERVAL;
+    }
+
+    int lineHeight = OVERLAY_FONT_SIZE + 4;
+    int overlayHeight = OVERLAY_GRAPH_HEIGHT + (ZONE_COUNT + 1) * lineHeight + 3 * OVERLAY_MARGIN;
+    DrawRectangle(0, 0, OVERLAY_WIDTH, overlayHeight, Fade(BLACK, 0.75f));
+
+    // Frame time graph, newest frame on the right
+    int graphX = OVERLAY_MARGIN;
+    int graphBottom = OVERLAY_MARGIN + OVERLAY_GRAPH_HEIGHT;
+    float pixelsPerMs = OVERLAY_GRAPH_HEIGHT / OVERLAY_GRAPH_MAX_MS;
+    float budgetMs = 1000.0f / ((MAX_FRAMERATE > 0) ? MAX_FRAMERATE : 60);
+
+    unsigned int frames = (profiler->frameCount < OVERLAY_GRAPH_FRAMES) ? profiler->frameCount : OVERLAY_GRAPH_FRAMES;
+    for (unsigned int i = 0; i < frames; i++)
+    {
+        unsigned int slot = (profiler->frameCount - frames + i) % PROFILER_HISTORY;
+        float frameMs = profiler->history[slot][ZONE_FRAME];
+        int barHeight = (int)(((frameMs < OVERLAY_GRAPH_MAX_MS) ? frameMs : OVERLAY_GRAPH_MAX_MS) * pixelsPerMs);
+        Color barColor = (frameMs <= budgetMs * 1.05f) ? GREEN : RED; // a little slack for timer jitter
+        DrawRectangle(graphX + (int)(OVERLAY_GRAPH_FRAMES - frames + i), graphBottom - barHeight, 1, barHeight, barColor);
+    }
+
+    int budgetY = graphBottom - (int)(budgetMs * pixelsPerMs);
+    DrawRectangle(graphX, budgetY, OVERLAY_GRAPH_FRAMES, 1, YELLOW);
+    DrawText(TextFormat("%.2f ms budget", budgetMs), graphX + OVERLAY_GRAPH_FRAMES + OVERLAY_MARGIN,
+             budgetY - OVERLAY_FONT_SIZE / 2, OVERLAY_FONT_SIZE, YELLOW);
+
+    // Percentiles for every zone
+    int textY = graphBottom + OVERLAY_MARGIN;
+    int columnX[4] = { OVERLAY_MARGIN, OVERLAY_MARGIN + 110, OVERLAY_MARGIN + 210, OVERLAY_MARGIN + 310 };
+    DrawText("ms", columnX[0], textY, OVERLAY_FONT_SIZE, LIGHTGRAY);
+    DrawText("p50", columnX[1], textY, OVERLAY_FONT_SIZE, LIGHTGRAY);
+    DrawText("p99", columnX[2], textY, OVERLAY_FONT_SIZE, LIGHTGRAY);
+    DrawText("max", columnX[3], textY, OVERLAY_FONT_SIZE, LIGHTGRAY);
+    for (int zone = 0; zone < ZONE_COUNT; zone++)
+    {
+        textY += lineHeight;
+        const ProfileStats *stats = &profiler->stats[zone];
+        DrawText(zoneNames[zone], columnX[0], textY, OVERLAY_FONT_SIZE, RAYWHITE);
+        DrawText(TextFormat("%.2f", stats->p50), columnX[1], textY, OVERLAY_FONT_SIZE, RAYWHITE);
+        DrawText(TextFormat("%.2f", stats->p99), columnX[2], textY, OVERLAY_FONT_SIZE, RAYWHITE);
+        DrawText(TextFormat("%.2f", stats->max), columnX[3], textY, OVERLAY_FONT_SIZE, RAYWHITE);
+    }
+}
+
+bool SaveProfilerCsv(const Profiler *profiler, const char *fileName)
+{
+    FILE *file = fopen(fileName, "w");
+    if (file == NULL)
+    {
+        TraceLog(LOG_WARNING, "PROFILER: Could not open %s", fileName);
+        return false;
+    }
+
+    fprintf(file, "frame");
+    for (int zone = 0; zone < ZONE_COUNT; zone++)
+        fprintf(file, ",%s_ms", zoneNames[zone]);
+    fprintf(file, "\n");
+
+    unsigned int frames = GetRecordedFrames(profiler);
+    for (unsigned int i = 0; i < frames; i++)
+    {
+        unsigned int frame = profiler->frameCount - frames + i;
+        fprintf(file, "%u", frame);
+        for (int zone = 0; zone < ZONE_COUNT; zone++)
+            fprintf(file, ",%.4f", profiler->history[frame % PROFILER_HISTORY][zone]);
+        fprintf(file, "\n");
+    }
+
+    fclose(file);
+    return true;
+}
+
+void TraceStartupStep(StartupTrace *trace, const char *name, double startTime)
+{
+    double now = GetTime();
+    float stepTime = (float)((now - startTime) * 1000.0);
+    trace->stepTotal += stepTime;
+    trace->stepCount++;
+    TraceLog(LOG_INFO, "STARTUP: %-18s %8.2f ms (done at %.2f ms)", name, stepTime, now * 1000.0);
+}
+
+void TraceStartupFirstFrame(StartupTrace *trace)
+{
+    if (trace->hasFirstFrame)
+        return;
+
+    trace->hasFirstFrame = true;
+    trace->firstFrameTime = (float)(GetTime() * 1000.0);
+    TraceLog(LOG_INFO, "STARTUP: First frame shown at %.2f ms", trace->firstFrameTime);
+}
+
+void TraceStartupReady(StartupTrace *trace)
+{
+    TraceLog(LOG_INFO, "STARTUP: Ready at %.2f ms, %i steps took %.2f ms, first frame at %.2f ms",
+             GetTime() * 1000.0, trace->stepCount, trace->stepTotal, trace->firstFrameTime);
+}
+
+static unsigned int GetRecordedFrames(const Profiler *profiler)
+{
+    // One slot always belongs to the frame in progress
+    return (profiler->frameCount < PROFILER_HISTORY - 1) ? profiler->frameCount : PROFILER_HISTORY - 1;
+}
+
+static int CompareFloats(const void *a, const void *b)
+{
+    float difference = *(const float *)a - *(const float *)b;
+    return (difference > 0) - (difference < 0);
+}
+
+static void UpdateProfileStats(Profiler *profiler)
+{
+    unsigned int frames = GetRecordedFrames(profiler);
+    if (frames == 0)
+        return;
+
+    float sorted[PROFILER_HISTORY];
+    for (int zone = 0; zone < ZONE_COUNT; zone++)
+    {
+        for (unsigned int i = 0; i < frames; i++)
+            sorted[i] = profiler->history[(profiler->frameCount - 1 - i) % PROFILER_HISTORY][zone];
+        qsort(sorted, frames, sizeof(float), CompareFloats);
+
+        profiler->stats[zone].p50 = sorted[frames * 50 / 100];
+        profiler->stats[zone].p99 = sorted[frames * 99 / 100];
+        profiler->stats[zone].max = sorted[frames - 1];
+    }
+}
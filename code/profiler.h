@@ -0,0 +1,72 @@
+// EXPLANATION:
+// Measures how long each part of a frame takes, and shows it in an overlay
+// Press F3 to show/hide the overlay, and F4 to save the recorded frames to a CSV file
+// Only the main thread records, so the history is a plain ring buffer with no locks
+//
+// Startup is traced separately, straight to the log: how long each init step took,
+// when the first frame was shown and when the game was fully ready. Times are from
+// when the window opened, raylib's clock doesn't start before that
+
+#ifndef PONG_PROFILER_HEADER_GUARD
+#define PONG_PROFILER_HEADER_GUARD
+
+#include "raylib.h"
+
+// Macros
+// --------------------------------------------------------------------------------
+#define PROFILER_HISTORY 512        // Ring buffer slots, one is the frame in progress (power of two)
+#define PROFILER_STATS_INTERVAL 15  // Frames between percentile updates while the overlay is shown
+#define PROFILER_TOGGLE_KEY KEY_F3
+#define PROFILER_SAVE_KEY KEY_F4
+
+// Types and Structures
+// --------------------------------------------------------------------------------
+typedef enum ProfileZone
+{
+    ZONE_UPDATE,  // Input and game logic
+    ZONE_DRAW,    // Drawing the game to the render texture
+    ZONE_BLIT,    // Scaling the render texture to the window
+    ZONE_PRESENT, // EndDrawing(): flushing to the GPU, swapping buffers, waiting for the frame cap
+    ZONE_FRAME,   // Whole frame, from one frame's start to the next
+    ZONE_COUNT
+} ProfileZone;
+
+typedef struct ProfileStats // Milliseconds
+{
+    float p50;
+    float p99;
+    float max;
+} ProfileStats;
+
+typedef struct Profiler
+{
+    float history[PROFILER_HISTORY][ZONE_COUNT]; // Milliseconds
+    unsigned int frameCount; // Frames recorded so far, the newest is at (frameCount - 1) % PROFILER_HISTORY
+    double zoneStart[ZONE_COUNT];
+    ProfileStats stats[ZONE_COUNT];
+    int framesUntilStats;
+    int savedCount; // Used to number the CSV files
+    bool showOverlay;
+} Profiler;
+
+typedef struct StartupTrace // Milliseconds since the window opened
+{
+    float stepTotal; // All the traced steps added up
+    int stepCount;
+    float firstFrameTime; // 0 until the first frame is shown
+    bool hasFirstFrame;
+} StartupTrace;
+
+// Prototypes
+// --------------------------------------------------------------------------------
+Profiler InitProfiler(void);
+void BeginProfileFrame(Profiler *profiler); // Call at the start of every frame, also handles the hotkeys
+void BeginProfileZone(Profiler *profiler, ProfileZone zone);
+void EndProfileZone(Profiler *profiler, ProfileZone zone); // Adds the time since BeginProfileZone() to this frame
+void DrawProfilerOverlay(Profiler *profiler); // Call between BeginDrawing() and EndDrawing(), in window coordinates
+bool SaveProfilerCsv(const Profiler *profiler, const char *fileName); // One row per recorded frame, oldest first
+void TraceStartupStep(StartupTrace *trace, const char *name, double startTime); // Logs a step that began at GetTime() startTime and just finished
+void TraceStartupFirstFrame(StartupTrace *trace); // Call after every frame, only logs the first
+void TraceStartupReady(StartupTrace *trace); // Everything's initialized, logs the totals
+
+#endif // PONG_PROFILER_HEADER_GUARD
@@ -0,0 +1,335 @@
+// EXPLANATION:
+// Sends the game's drawing to raylib, or to a software canvas in memory
+// See render.h for more documentation/descriptions
+
+#include "render.h"
+
+#include <math.h>   // for floorf() and ceilf()
+#include <string.h> // for memcpy()
+
+#define MIN(a, b) ((a)<(b)? (a) : (b))
+#define MAX(a, b) ((a)>(b)? (a) : (b))
+
+// Types and Structures
+// --------------------------------------------------------------------------------
+typedef struct CanvasGlyph
+{
+    int width;
+    unsigned short columns[CANVAS_GLYPH_MAX_WIDTH];
+} CanvasGlyph;
+
+// Local Variables Definition
+// --------------------------------------------------------------------------------
+static Canvas *activeCanvas = NULL;
+
+// raylib's default font (see LoadFontDefault() in rtext.c), printable ASCII from ' ' to '~'
+// Width in font pixels, then one entry per column, lowest bit is the top row
+static const CanvasGlyph canvasFont[95] = {
+    { 3, { 0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000 } }, // space
+    { 1, { 0x0BF, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000 } }, // !
+    { 4, { 0x004, 0x002, 0x004, 0x002, 0x000, 0x000, 0x000 } }, // "
+    { 6, { 0x044, 0x0FE, 0x044, 0x044, 0x0FE, 0x044, 0x000 } }, // #
+    { 5, { 0x09E, 0x092, 0x1FF, 0x092, 0x0F2, 0x000, 0x000 } }, // $
+    { 7, { 0x08E, 0x04A, 0x02E, 0x010, 0x0E8, 0x0A4, 0x0E2 } }, // %
+    { 6, { 0x0EC, 0x094, 0x094, 0x0EC, 0x060, 0x090, 0x000 } }, // &
+    { 2, { 0x004, 0x002, 0x000, 0x000, 0x000, 0x000, 0x000 } }, // '
+    { 3, { 0x0FE, 0x101, 0x101, 0x000, 0x000, 0x000, 0x000 } }, // (
+    { 3, { 0x101, 0x101, 0x0FE, 0x000, 0x000, 0x000, 0x000 } }, // )
+    { 5, { 0x010, 0x054, 0x038, 0x054, 0x010, 0x000, 0x000 } }, // *
+    { 5, { 0x010, 0x010, 0x07C, 0x010, 0x010, 0x000, 0x000 } }, // +
+    { 2, { 0x100, 0x080, 0x000, 0x000, 0x000, 0x000, 0x000 } }, // ,
+    { 4, { 0x010, 0x010, 0x010, 0x010, 0x000, 0x000, 0x000 } }, // -
+    { 1, { 0x080, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000 } }, // .
+    { 7, { 0x080, 0x040, 0x020, 0x010, 0x008, 0x004, 0x002 } }, // /
+    { 5, { 0x0FE, 0x082, 0x082, 0x082, 0x0FE, 0x000, 0x000 } }, // 0
+    { 2, { 0x002, 0x0FE, 0x000, 0x000, 0x000, 0x000, 0x000 } }, // 1
+    { 5, { 0x0F2, 0x092, 0x092, 0x092, 0x09E, 0x000, 0x000 } }, // 2
+    { 5, { 0x082, 0x092, 0x092, 0x092, 0x0FE, 0x000, 0x000 } }, // 3
+    { 5, { 0x01E, 0x010, 0x010, 0x010, 0x0FE, 0x000, 0x000 } }, // 4
+    { 5, { 0x09E, 0x092, 0x092, 0x092, 0x0F2, 0x000, 0x000 } }, // 5
+    { 5, { 0x0FE, 0x092, 0x092, 0x092, 0x0F2, 0x000, 0x000 } }, // 6
+    { 5, { 0x002, 0x002, 0x002, 0x002, 0x0FE, 0x000, 0x000 } }, // 7
+    { 5, { 0x0FE, 0x092, 0x092, 0x092, 0x0FE, 0x000, 0x000 } }, // 8
+    { 5, { 0x09E, 0x092, 0x092, 0x092, 0x0FE, 0x000, 0x000 } }, // 9
+    { 1, { 0x048, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000 } }, // :
+    { 1, { 0x1A0, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000 } }, // ;
+    { 3, { 0x010, 0x028, 0x044, 0x000, 0x000, 0x000, 0x000 } }, // <
+    { 4, { 0x028, 0x028, 0x028, 0x028, 0x000, 0x000, 0x000 } }, // =
+    { 3, { 0x044, 0x028, 0x010, 0x000, 0x000, 0x000, 0x000 } }, // >
+    { 6, { 0x00E, 0x002, 0x0B2, 0x012, 0x012, 0x01E, 0x000 } }, // ?
+    { 7, { 0x1FC, 0x104, 0x174, 0x154, 0x174, 0x144, 0x17C } }, // @
+    { 6, { 0x0FE, 0x012, 0x012, 0x012, 0x012, 0x0FE, 0x000 } }, // A
+    { 6, { 0x0FE, 0x092, 0x092, 0x092, 0x092, 0x0EE, 0x000 } }, // B
+    { 6, { 0x0FE, 0x082, 0x082, 0x082, 0x082, 0x0C6, 0x000 } }, // C
+    { 6, { 0x0FE, 0x082, 0x082, 0x082, 0x082, 0x07C, 0x000 } }, // D
+    { 6, { 0x0FE, 0x092, 0x092, 0x092, 0x092, 0x082, 0x000 } }, // E
+    { 6, { 0x0FE, 0x012, 0x012, 0x012, 0x012, 0x002, 0x000 } }, // F
+    { 6, { 0x0FE, 0x082, 0x082, 0x082, 0x092, 0x0F6, 0x000 } }, // G
+    { 6, { 0x0FE, 0x010, 0x010, 0x010, 0x010, 0x0FE, 0x000 } }, // H
+    { 3, { 0x082, 0x0FE, 0x082, 0x000, 0x000, 0x000, 0x000 } }, // I
+    { 5, { 0x042, 0x082, 0x082, 0x082, 0x07E, 0x000, 0x000 } }, // J
+    { 6, { 0x0FE, 0x010, 0x010, 0x010, 0x028, 0x0C6, 0x000 } }, // K
+    { 5, { 0x0FE, 0x080, 0x080, 0x080, 0x080, 0x000, 0x000 } }, // L
+    { 7, { 0x0FE, 0x004, 0x008, 0x010, 0x008, 0x004, 0x0FE } }, // M
+    { 6, { 0x0FE, 0x008, 0x010, 0x020, 0x040, 0x0FE, 0x000 } }, // N
+    { 6, { 0x0FE, 0x082, 0x082, 0x082, 0x082, 0x0FE, 0x000 } }, // O
+    { 6, { 0x0FE, 0x012, 0x012, 0x012, 0x012, 0x01E, 0x000 } }, // P
+    { 6, { 0x0FE, 0x082, 0x082, 0x0C2, 0x182, 0x0FE, 0x000 } }, // Q
+    { 6, { 0x0FE, 0x012, 0x012, 0x032, 0x052, 0x09E, 0x000 } }, // R
+    { 6, { 0x09E, 0x092, 0x092, 0x092, 0x092, 0x0F2, 0x000 } }, // S
+    { 7, { 0x002, 0x002, 0x002, 0x0FE, 0x002, 0x002, 0x002 } }, // T
+    { 6, { 0x0FE, 0x080, 0x080, 0x080, 0x080, 0x0FE, 0x000 } }, // U
+    { 7, { 0x01E, 0x020, 0x040, 0x080, 0x040, 0x020, 0x01E } }, // V
+    { 7, { 0x0FE, 0x080, 0x080, 0x0FC, 0x080, 0x080, 0x0FE } }, // W
+    { 6, { 0x0EE, 0x010, 0x010, 0x010, 0x010, 0x0EE, 0x000 } }, // X
+    { 6, { 0x09E, 0x090, 0x090, 0x090, 0x090, 0x0FE, 0x000 } }, // Y
+    { 6, { 0x082, 0x0C2, 0x0A2, 0x092, 0x08A, 0x086, 0x000 } }, // Z
+    { 2, { 0x1FF, 0x101, 0x000, 0x000, 0x000, 0x000, 0x000 } }, // [
+    { 7, { 0x002, 0x004, 0x008, 0x010, 0x020, 0x040, 0x080 } }, // backslash
+    { 2, { 0x101, 0x1FF, 0x000, 0x000, 0x000, 0x000, 0x000 } }, // ]
+    { 3, { 0x004, 0x002, 0x004, 0x000, 0x000, 0x000, 0x000 } }, // ^
+    { 5, { 0x080, 0x080, 0x080, 0x080, 0x080, 0x000, 0x000 } }, // _
+    { 2, { 0x002, 0x004, 0x000, 0x000, 0x000, 0x000, 0x000 } }, // `
+    { 5, { 0x0E8, 0x0A8, 0x0A8, 0x0A8, 0x0F8, 0x000, 0x000 } }, // a
+    { 5, { 0x0FE, 0x088, 0x088, 0x088, 0x0F8, 0x000, 0x000 } }, // b
+    { 5, { 0x0F8, 0x088, 0x088, 0x088, 0x088, 0x000, 0x000 } }, // c
+    { 5, { 0x0F8, 0x088, 0x088, 0x088, 0x0FE, 0x000, 0x000 } }, // d
+    { 5, { 0x0F8, 0x0A8, 0x0A8, 0x0A8, 0x0B8, 0x000, 0x000 } }, // e
+    { 4, { 0x3FC, 0x024, 0x024, 0x004, 0x000, 0x000, 0x000 } }, // f
+    { 5, { 0x2F8, 0x288, 0x288, 0x288, 0x3F8, 0x000, 0x000 } }, // g
+    { 5, { 0x0FE, 0x008, 0x008, 0x008, 0x0F8, 0x000, 0x000 } }, // h
+    { 1, { 0x0FA, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000 } }, // i
+    { 2, { 0x200, 0x3FA, 0x000, 0x000, 0x000, 0x000, 0x000 } }, // j
+    { 5, { 0x0FE, 0x020, 0x020, 0x050, 0x088, 0x000, 0x000 } }, // k
+    { 2, { 0x0FE, 0x080, 0x000, 0x000, 0x000, 0x000, 0x000 } }, // l
+    { 5, { 0x0F8, 0x008, 0x0F8, 0x008, 0x0F8, 0x000, 0x000 } }, // m
+    { 5, { 0x0F8, 0x008, 0x008, 0x008, 0x0F8, 0x000, 0x000 } }, // n
+    { 5, { 0x0F8, 0x088, 0x088, 0x088, 0x0F8, 0x000, 0x000 } }, // o
+    { 5, { 0x3F8, 0x088, 0x088, 0x088, 0x0F8, 0x000, 0x000 } }, // p
+    { 5, { 0x0F8, 0x088, 0x088, 0x088, 0x3F8, 0x000, 0x000 } }, // q
+    { 5, { 0x0F8, 0x008, 0x008, 0x008, 0x008, 0x000, 0x000 } }, // r
+    { 5, { 0x0B8, 0x0A8, 0x0A8, 0x0A8, 0x0E8, 0x000, 0x000 } }, // s
+    { 4, { 0x0FE, 0x088, 0x088, 0x080, 0x000, 0x000, 0x000 } }, // t
+    { 5, { 0x0F8, 0x080, 0x080, 0x080, 0x0F8, 0x000, 0x000 } }, // u
+    { 5, { 0x038, 0x040, 0x080, 0x040, 0x038, 0x000, 0x000 } }, // v
+    { 5, { 0x0F8, 0x080, 0x0F0, 0x080, 0x0F8, 0x000, 0x000 } }, // w
+    { 5, { 0x088, 0x050, 0x020, 0x050, 0x088, 0x000, 0x000 } }, // x
+    { 5, { 0x2F8, 0x280, 0x280, 0x280, 0x3F8, 0x000, 0x000 } }, // y
+    { 5, { 0x088, 0x0C8, 0x0A8, 0x098, 0x088, 0x000, 0x000 } }, // z
+    { 3, { 0x010, 0x1EF, 0x101, 0x000, 0x000, 0x000, 0x000 } }, // {
+    { 1, { 0x1FF, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000 } }, // |
+    { 3, { 0x101, 0x1EF, 0x010, 0x000, 0x000, 0x000, 0x000 } }, // }
+    { 4, { 0x020, 0x010, 0x020, 0x010, 0x000, 0x000, 0x000 } }, // ~
+};
+
+// Local Functions Declaration
+// --------------------------------------------------------------------------------
+static void FillCanvasRect(Canvas *canvas, int left, int top, int right, int bottom, Color color); // Clipped, right and bottom are exclusive
+static Color BlendColor(Color dst, Color src); // Same as raylib's default alpha blending
+static const CanvasGlyph *GetCanvasGlyph(char c); // '?' for anything the font doesn't have, like raylib
+static int GetPixelCenterEdge(float edge); // First pixel whose center is at or past the edge, which is how the GPU fills quads
+
+Canvas LoadCanvas(int width, int height)
+{
+    Canvas canvas = { 0 };
+    canvas.width = width;
+    canvas.height = height;
+    canvas.pixels = MemAlloc(width * height * sizeof(Color));
+    return canvas;
+}
+
+void UnloadCanvas(Canvas *canvas)
+{
+    if (activeCanvas == canvas)
+        activeCanvas = NULL;
+    MemFree(canvas->pixels);
+    canvas->pixels = NULL;
+}
+
+void SetRenderCanvas(Canvas *canvas)
+{
+    activeCanvas = canvas;
+}
+
+Canvas *GetRenderCanvas(void)
+{
+    return activeCanvas;
+}
+
+unsigned int GetCanvasHash(const Canvas *canvas)
+{
+    // A whole pixel at a time, packed the same way on any byte order
+    unsigned int hash = 2166136261u;
+    int count = canvas->width * canvas->height;
+    for (int i = 0; i < count; i++)
+    {
+        Color pixel = canvas->pixels[i];
+        unsigned int word = (unsigned int)pixel.r | ((unsigned int)pixel.g << 8) |
+                            ((unsigned int)pixel.b << 16) | ((unsigned int)pixel.a << 24);
+        hash = (hash ^ word) * 16777619u;
+    }
+    return hash;
+}
+
+void RenderClear(Color color)
+{
+    if (activeCanvas == NULL)
+    {
+        ClearBackground(color);
+        return;
+    }
+
+    // Fill the first row, then copy it down
+    Color *pixels = activeCanvas->pixels;
+    int width = activeCanvas->width;
+    for (int x = 0; x < width; x++)
+        pixels[x] = color;
+    for (int y = 1; y < activeCanvas->height; y++)
+        memcpy(&pixels[y * width], pixels, width * sizeof(Color));
+}
+
+void RenderRectangle(int posX, int posY, int width, int height, Color color)
+{
+    if (activeCanvas == NULL)
+        DrawRectangle(posX, posY, width, height, color);
+    else
+        FillCanvasRect(activeCanvas, posX, posY, posX + width, posY + height, color);
+}
+
+void RenderTriangle(Vector2 v1, Vector2 v2, Vector2 v3, Color color)
+{
+    if (activeCanvas == NULL)
+    {
+        DrawTriangle(v1, v2, v3, color);
+        return;
+    }
+
+    int left = MAX((int)floorf(MIN(v1.x, MIN(v2.x, v3.x))), 0);
+    int right = MIN((int)ceilf(MAX(v1.x, MAX(v2.x, v3.x))), activeCanvas->width);
+    int top = MAX((int)floorf(MIN(v1.y, MIN(v2.y, v3.y))), 0);
+    int bottom = MIN((int)ceilf(MAX(v1.y, MAX(v2.y, v3.y))), activeCanvas->height);
+
+    // Pixel centers inside all three edges, in either winding order
+    float area = (v2.x - v1.x) * (v3.y - v1.y) - (v2.y - v1.y) * (v3.x - v1.x);
+    if (area == 0.0f)
+        return;
+    float sign = (area > 0.0f) ? 1.0f : -1.0f;
+
+    for (int y = top; y < bottom; y++)
+    {
+        float py = (float)y + 0.5f;
+        for (int x = left; x < right; x++)
+        {
+            float px = (float)x + 0.5f;
+            float e1 = ((v2.x - v1.x) * (py - v1.y) - (v2.y - v1.y) * (px - v1.x)) * sign;
+            float e2 = ((v3.x - v2.x) * (py - v2.y) - (v3.y - v2.y) * (px - v2.x)) * sign;
+            float e3 = ((v1.x - v3.x) * (py - v3.y) - (v1.y - v3.y) * (px - v3.x)) * sign;
+            if (e1 >= 0.0f && e2 >= 0.0f && e3 >= 0.0f)
+            {
+                Color *pixel = &activeCanvas->pixels[y * activeCanvas->width + x];
+                *pixel = BlendColor(*pixel, color);
+            }
+        }
+    }
+}
+
+void RenderText(const char *text, int posX, int posY, int fontSize, Color color)
+{
+    if (activeCanvas == NULL)
+    {
+        DrawText(text, posX, posY, fontSize, color);
+        return;
+    }
+
+    // Same as DrawText(): every font pixel is scaled to a block, and letters
+    // are spaced fontSize/10 pixels apart. No newlines, the game doesn't use them
+    if (fontSize < CANVAS_FONT_SIZE)
+        fontSize = CANVAS_FONT_SIZE;
+    int spacing = fontSize / CANVAS_FONT_SIZE;
+    float scale = (float)fontSize / CANVAS_FONT_SIZE;
+    float penX = (float)posX;
+    for (const char *c = text; *c != '\0'; c++)
+    {
+        const CanvasGlyph *glyph = GetCanvasGlyph(*c);
+        for (int column = 0; column < glyph->width; column++)
+        {
+            int left = GetPixelCenterEdge(penX + column * scale);
+            int right = GetPixelCenterEdge(penX + (column + 1) * scale);
+            for (int row = 0; row < CANVAS_GLYPH_HEIGHT; row++)
+            {
+                if (glyph->columns[column] & (1 << row))
+                    FillCanvasRect(activeCanvas, left, GetPixelCenterEdge(posY + row * scale),
+                                   right, GetPixelCenterEdge(posY + (row + 1) * scale), color);
+            }
+        }
+        penX += glyph->width * scale + spacing;
+    }
+}
+
+int RenderMeasureText(const char *text, int fontSize)
+{
+    if (activeCanvas == NULL)
+        return MeasureText(text, fontSize);
+
+    int length = (int)strlen(text);
+    if (length == 0)
+        return 0;
+
+    // Same sum as MeasureText(), with no spacing after the last letter
+    if (fontSize < CANVAS_FONT_SIZE)
+        fontSize = CANVAS_FONT_SIZE;
+    int spacing = fontSize / CANVAS_FONT_SIZE;
+    int width = 0;
+    for (int i = 0; i < length; i++)
+        width += GetCanvasGlyph(text[i])->width;
+    return (int)(width * ((float)fontSize / CANVAS_FONT_SIZE) + (float)((length - 1) * spacing));
+}
+
+static void FillCanvasRect(Canvas *canvas, int left, int top, int right, int bottom, Color color)
+{
+    left = MAX(left, 0);
+    top = MAX(top, 0);
+    right = MIN(right, canvas->width);
+    bottom = MIN(bottom, canvas->height);
+    if (left >= right || top >= bottom || color.a == 0)
+        return;
+
+    for (int y = top; y < bottom; y++)
+    {
+        Color *row = &canvas->pixels[y * canvas->width];
+        if (color.a == 255)
+        {
+            for (int x = left; x < right; x++)
+                row[x] = color;
+        }
+        else
+        {
+            for (int x = left; x < right; x++)
+                row[x] = BlendColor(row[x], color);
+        }
+    }
+}
+
+static Color BlendColor(Color dst, Color src)
+{
+    int alpha = src.a;
+    int inverse = 255 - alpha;
+    return (Color){
+        (unsigned char)((src.r * alpha + dst.r * inverse + 127) / 255),
+        (unsigned char)((src.g * alpha + dst.g * inverse + 127) / 255),
+        (unsigned char)((src.b * alpha + dst.b * inverse + 127) / 255),
+        (unsigned char)(alpha + (dst.a * inverse + 127) / 255),
+    };
+}
+
+static const CanvasGlyph *GetCanvasGlyph(char c)
+{
+    if (c < ' ' || c > '~')
+        c = '?';
+    return &canvasFont[c - ' '];
+}
+
+static int GetPixelCenterEdge(float edge)
+{
+    return (int)ceilf(edge - 0.5f);
+}
@@ -0,0 +1,43 @@
+// EXPLANATION:
+// Sends the game's drawing to raylib, or to a software canvas in memory
+// The canvas only knows what the game draws: rectangles, triangles, and text in a
+// built-in copy of raylib's default font, laid out and measured the same way as
+// DrawText() and MeasureText(). It needs no window or GPU, so frames can be
+// rendered and compared on machines without one (see tools/capture.c)
+
+#ifndef PONG_RENDER_HEADER_GUARD
+#define PONG_RENDER_HEADER_GUARD
+
+#include "raylib.h"
+
+// Macros
+// --------------------------------------------------------------------------------
+#define CANVAS_FONT_SIZE 10 // Font size where every font pixel is one canvas pixel, same as raylib's default font
+#define CANVAS_GLYPH_MAX_WIDTH 7
+#define CANVAS_GLYPH_HEIGHT 10
+
+// Types and Structures
+// --------------------------------------------------------------------------------
+typedef struct Canvas
+{
+    int width;
+    int height;
+    Color *pixels; // width * height, row by row from the top
+} Canvas;
+
+// Prototypes
+// --------------------------------------------------------------------------------
+Canvas LoadCanvas(int width, int height);
+void UnloadCanvas(Canvas *canvas);
+void SetRenderCanvas(Canvas *canvas); // Draw to the canvas from now on, NULL to go back to raylib
+Canvas *GetRenderCanvas(void); // NULL when drawing with raylib
+unsigned int GetCanvasHash(const Canvas *canvas); // FNV-1a of every pixel, the same on any byte order, for comparing frames
+
+// Drawing, goes to whichever one is active
+void RenderClear(Color color);
+void RenderRectangle(int posX, int posY, int width, int height, Color color);
+void RenderTriangle(Vector2 v1, Vector2 v2, Vector2 v3, Color color);
+void RenderText(const char *text, int posX, int posY, int fontSize, Color color);
+int RenderMeasureText(const char *text, int fontSize);
+
+#endif // PONG_RENDER_HEADER_GUARD
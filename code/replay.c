@@ -0,0 +1,270 @@
+// EXPLANATION:
+// Records and plays back the input for every simulation step
+// See replay.h for more documentation/descriptions
+
+#include "replay.h"
+
+#include <stddef.h> // for NULL
+#include <string.h> // for memcpy()
+#include "raylib.h"
+
+#include "pong.h" // for SIM_TICK_RATE and ClearPongInputPresses()
+
+// Macros
+// --------------------------------------------------------------------------------
+#define REPLAY_MAGIC "PRPL"
+#define REPLAY_INITIAL_CAPACITY 4096
+
+// Local Functions Declaration
+// --------------------------------------------------------------------------------
+static void WriteReplayByte(PongReplay *replay, unsigned char byte); // Grows the buffer as needed
+static void WriteReplayVarint(PongReplay *replay, unsigned int value); // 7 bits per byte, high bit means more follow
+static bool ReadReplayByte(PongReplay *replay, unsigned char *byte);
+static bool ReadReplayVarint(PongReplay *replay, unsigned int *value);
+static bool ReadReplayEventHeader(PongReplay *replay); // Reads when the next event happens and its flags
+
+PongReplay InitReplayRecording(const char *fileName, unsigned int seed, GameMode mode, GameDifficulty difficulty)
+{
+    PongReplay replay =
+    {
+        .mode = REPLAY_RECORDING,
+        .fileName = fileName,
+        .seed = seed,
+        .gameMode = mode,
+        .difficulty = difficulty,
+        .data = MemAlloc(REPLAY_INITIAL_CAPACITY),
+        .capacity = REPLAY_INITIAL_CAPACITY,
+    };
+
+    for (int i = 0; i < 4; i++)
+        WriteReplayByte(&replay, (unsigned char)REPLAY_MAGIC[i]);
+    WriteReplayByte(&replay, REPLAY_VERSION);
+    for (int i = 0; i < 4; i++)
+        WriteReplayByte(&replay, (unsigned char)(seed >> (i * 8)));
+    WriteReplayByte(&replay, (unsigned char)mode);
+    WriteReplayByte(&replay, (unsigned char)difficulty);
+    WriteReplayByte(&replay, (unsigned char)(SIM_TICK_RATE & 0xFF));
+    WriteReplayByte(&replay, (unsigned char)(SIM_TICK_RATE >> 8));
+
+    return replay;
+}
+
+PongReplay LoadReplay(const char *fileName)
+{
+    PongReplay replay = { .mode = REPLAY_OFF, .fileName = fileName };
+
+    int fileSize = 0;
+    unsigned char *fileData = LoadFileData(fileName, &fileSize);
+    if (fileData == NULL)
+        return replay;
+
+    const unsigned char *header = fileData;
+    if (fileSize < REPLAY_HEADER_SIZE || memcmp(header, REPLAY_MAGIC, 4) != 0 || header[4] != REPLAY_VERSION)
+    {
+        TraceLog(LOG_WARNING, "REPLAY: [%s] Not a replay file, or from another version", fileName);
+        UnloadFileData(fileData);
+        return replay;
+    }
+
+    int tickRate = header[11] | (header[12] << 8);
+    if (tickRate != SIM_TICK_RATE || header[9] > MODE_DEMO || header[10] > DIFFICULTY_HARD)
+    {
+        TraceLog(LOG_WARNING, "REPLAY: [%s] Recorded with different game settings (%i steps per second)",
+                 fileName, tickRate);
+        UnloadFileData(fileData);
+        return replay;
+    }
+
+    replay.seed = (unsigned int)header[5] | (unsigned int)header[6] << 8 |
+                  (unsigned int)header[7] << 16 | (unsigned int)header[8] << 24;
+    replay.gameMode = (GameMode)header[9];
+    replay.difficulty = (GameDifficulty)header[10];
+
+    replay.data = MemAlloc(fileSize);
+    memcpy(replay.data, fileData, fileSize);
+    UnloadFileData(fileData);
+    replay.size = fileSize;
+    replay.capacity = fileSize;
+    replay.cursor = REPLAY_HEADER_SIZE;
+
+    if (ReadReplayEventHeader(&replay))
+        replay.mode = REPLAY_PLAYING;
+    else
+        FreeReplay(&replay);
+
+    return replay;
+}
+
+bool SaveReplay(PongReplay *replay)
+{
+    if (replay->mode != REPLAY_RECORDING)
+        return false;
+
+    // End marker, so steps after the last event are played too
+    WriteReplayVarint(replay, replay->tick - replay->eventTick);
+    WriteReplayByte(replay, 0);
+    replay->mode = REPLAY_OFF;
+
+    bool saved = SaveFileData(replay->fileName, replay->data, replay->size);
+    if (saved)
+        TraceLog(LOG_INFO, "REPLAY: [%s] Saved %u steps in %i bytes", replay->fileName, replay->tick, replay->size);
+
+    return saved;
+}
+
+void FreeReplay(PongReplay *replay)
+{
+    MemFree(replay->data);
+    replay->data = NULL;
+    replay->size = 0;
+    replay->capacity = 0;
+    replay->mode = REPLAY_OFF;
+}
+
+void RecordReplayTick(PongReplay *replay, const PongInput *input)
+{
+    unsigned char flags = 0;
+    if (input->moveL != replay->input.moveL || input->moveR != replay->input.moveR)
+        flags |= REPLAY_EVENT_MOVE;
+    if (input->mouseY != replay->input.mouseY)
+        flags |= REPLAY_EVENT_MOUSE_Y;
+    if (input->mouseMoved)
+        flags |= REPLAY_EVENT_MOUSE_MOVED;
+    if (input->pausePressed)
+        flags |= REPLAY_EVENT_PAUSE;
+    if (input->skipPressed)
+        flags |= REPLAY_EVENT_SKIP;
+
+    if (flags != 0)
+    {
+        WriteReplayVarint(replay, replay->tick - replay->eventTick);
+        WriteReplayByte(replay, flags);
+
+        // Paddle movement is always a whole number from -2 to 2
+        if (flags & REPLAY_EVENT_MOVE)
+            WriteReplayByte(replay, (unsigned char)((int)(input->moveL + 2) | (int)(input->moveR + 2) << 4));
+
+        // Mouse height is in whole pixels, so store the change as a small number
+        if (flags & REPLAY_EVENT_MOUSE_Y)
+        {
+            int change = (int)input->mouseY - (int)replay->input.mouseY;
+            WriteReplayVarint(replay, ((unsigned int)change << 1) ^ (unsigned int)(change >> 31)); // zigzag
+        }
+
+        replay->input = *input;
+        replay->eventTick = replay->tick;
+    }
+
+    replay->tick++;
+}
+
+bool PlayReplayTick(PongReplay *replay, PongInput *input)
+{
+    if (replay->mode != REPLAY_PLAYING)
+        return false;
+
+    ClearPongInputPresses(&replay->input);
+
+    if (replay->tick == replay->eventTick)
+    {
+        unsigned char flags = replay->eventFlags;
+        if (flags == 0)
+        {
+            replay->mode = REPLAY_OFF; // End marker
+            return false;
+        }
+
+        unsigned char moves = 0;
+        unsigned int mouseChange = 0;
+        if (((flags & REPLAY_EVENT_MOVE) && !ReadReplayByte(replay, &moves)) ||
+            ((flags & REPLAY_EVENT_MOUSE_Y) && !ReadReplayVarint(replay, &mouseChange)))
+        {
+            replay->mode = REPLAY_OFF; // Cut off
+            return false;
+        }
+
+        if (flags & REPLAY_EVENT_MOVE)
+        {
+            replay->input.moveL = (float)((moves & 0x0F) - 2);
+            replay->input.moveR = (float)((moves >> 4) - 2);
+        }
+        if (flags & REPLAY_EVENT_MOUSE_Y)
+        {
+            int change = (int)(mouseChange >> 1) ^ -(int)(mouseChange & 1);
+            replay->input.mouseY = (float)((int)replay->input.mouseY + change);
+        }
+        replay->input.mouseMoved = (flags & REPLAY_EVENT_MOUSE_MOVED) != 0;
+        replay->input.pausePressed = (flags & REPLAY_EVENT_PAUSE) != 0;
+        replay->input.skipPressed = (flags & REPLAY_EVENT_SKIP) != 0;
+
+        if (!ReadReplayEventHeader(replay))
+        {
+            // Cut off, so stop after this step
+            replay->eventTick = replay->tick + 1;
+            replay->eventFlags = 0;
+        }
+    }
+
+    *input = replay->input;
+    replay->tick++;
+
+    return true;
+}
+
+static void WriteReplayByte(PongReplay *replay, unsigned char byte)
+{
+    if (replay->size == replay->capacity)
+    {
+        replay->capacity *= 2;
+        replay->data = MemRealloc(replay->data, replay->capacity);
+    }
+
+    replay->data[replay->size++] = byte;
+}
+
+static void WriteReplayVarint(PongReplay *replay, unsigned int value)
+{
+    while (value >= 0x80)
+    {
+        WriteReplayByte(replay, (unsigned char)(value | 0x80));
+        value >>= 7;
+    }
+    WriteReplayByte(replay, (unsigned char)value);
+}
+
+static bool ReadReplayByte(PongReplay *replay, unsigned char *byte)
+{
+    if (replay->cursor >= replay->size)
+        return false;
+
+    *byte = replay->data[replay->cursor++];
+    return true;
+}
+
+static bool ReadReplayVarint(PongReplay *replay, unsigned int *value)
+{
+    *value = 0;
+    for (int shift = 0; shift < 32; shift += 7)
+    {
+        unsigned char byte;
+        if (!ReadReplayByte(replay, &byte))
+            return false;
+
+        *value |= (unsigned int)(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0)
+            return true;
+    }
+
+    return false; // Too long to be valid
+}
+
+static bool ReadReplayEventHeader(PongReplay *replay)
+{
+    unsigned int ticksUntilEvent;
+    if (!ReadReplayVarint(replay, &ticksUntilEvent) ||
+        !ReadReplayByte(replay, &replay->eventFlags))
+        return false;
+
+    replay->eventTick += ticksUntilEvent;
+    return true;
+}
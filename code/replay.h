@@ -0,0 +1,69 @@
+// EXPLANATION:
+// Records the input for every simulation step to a small binary file, and plays
+// it back so a match can be reproduced exactly, with or without a window
+//
+// File layout (all numbers little endian):
+//   header: "PRPL", version (1 byte), seed (4 bytes), mode (1 byte),
+//           difficulty (1 byte), tick rate (2 bytes)
+//   events: only written on steps where the input changed or a button was pressed
+//           varint    steps since the previous event
+//           1 byte    REPLAY_EVENT_* flags
+//           1 byte    moveL + 2 in the low 4 bits, moveR + 2 in the high 4 bits (if REPLAY_EVENT_MOVE)
+//           varint    zigzag encoded change in mouseY (if REPLAY_EVENT_MOUSE_Y)
+//   end:    varint steps since the previous event, then flags of 0
+
+#ifndef PONG_REPLAY_HEADER_GUARD
+#define PONG_REPLAY_HEADER_GUARD
+
+#include "states.h"
+
+// Macros
+// --------------------------------------------------------------------------------
+#define REPLAY_VERSION 3 // 2: random numbers come from the game's own PongRng, 3: bounce angles come from the paddle hit table
+#define REPLAY_HEADER_SIZE 13
+
+// Event flags
+#define REPLAY_EVENT_MOVE        0x01 // moveL or moveR changed
+#define REPLAY_EVENT_MOUSE_Y     0x02
+#define REPLAY_EVENT_MOUSE_MOVED 0x04 // The rest are presses, only set for that one step
+#define REPLAY_EVENT_PAUSE       0x08
+#define REPLAY_EVENT_SKIP        0x10
+
+// Types and Structures
+// --------------------------------------------------------------------------------
+typedef enum ReplayMode
+{
+    REPLAY_OFF, REPLAY_RECORDING, REPLAY_PLAYING
+} ReplayMode;
+
+typedef struct PongReplay
+{
+    ReplayMode mode;
+    const char *fileName;
+
+    // Everything needed to start the same match again
+    unsigned int seed;
+    GameMode gameMode;
+    GameDifficulty difficulty;
+
+    unsigned char *data; // Encoded file, including the header
+    int size;
+    int capacity;
+    int cursor; // Read position while playing
+
+    unsigned int tick; // Steps recorded or played so far
+    unsigned int eventTick; // Recording: step of the last event, playing: step of the next one
+    unsigned char eventFlags; // Playing: flags of the next event
+    PongInput input; // Input as of the last event
+} PongReplay;
+
+// Prototypes
+// --------------------------------------------------------------------------------
+PongReplay InitReplayRecording(const char *fileName, unsigned int seed, GameMode mode, GameDifficulty difficulty);
+PongReplay LoadReplay(const char *fileName); // mode is REPLAY_OFF if the file is missing or invalid
+bool SaveReplay(PongReplay *replay); // Finishes a recording and writes it to its file
+void FreeReplay(PongReplay *replay); // Also sets mode to REPLAY_OFF
+void RecordReplayTick(PongReplay *replay, const PongInput *input); // Call once per step, before StepPong()
+bool PlayReplayTick(PongReplay *replay, PongInput *input); // Sets this step's input, false once the replay has ended
+
+#endif // PONG_REPLAY_HEADER_GUARD
@@ -0,0 +1,97 @@
+// EXPLANATION:
+// Hold R during a match to scrub back through the last few seconds
+// See rewind.h for more documentation/descriptions
+
+#include "rewind.h"
+
+#include <stddef.h> // for NULL
+#include "raylib.h"
+
+#include "config.h" // for RENDER_WIDTH and RENDER_HEIGHT
+#include "pong.h" // for SIM_TICK_RATE and DIFFICULTY_FONT_SIZE
+#include "render.h"
+#include "ui.h" // for MeasureTextCached()
+
+PongRewind InitRewind(float seconds)
+{
+    PongRewind rewind = { 0 };
+    if (seconds > REWIND_MAX_SECONDS)
+        seconds = REWIND_MAX_SECONDS;
+    if (seconds <= 0.0f)
+        return rewind;
+
+    rewind.capacity = (int)(seconds * SIM_TICK_RATE / REWIND_TICKS_PER_SNAPSHOT);
+    if (rewind.capacity < 1)
+        rewind.capacity = 1;
+    rewind.snapshots = MemAlloc(rewind.capacity * sizeof(PongSnapshot));
+    TraceLog(LOG_INFO, "REWIND: %.1f seconds kept, %i KB", seconds,
+             (int)(rewind.capacity * sizeof(PongSnapshot) / 1024));
+
+    return rewind;
+}
+
+void FreeRewind(PongRewind *rewind)
+{
+    MemFree(rewind->snapshots);
+    *rewind = (PongRewind){ 0 };
+}
+
+void ClearRewind(PongRewind *rewind)
+{
+    rewind->count = 0;
+    rewind->head = 0;
+    rewind->ticksSinceSnapshot = 0;
+    rewind->scrubTicks = 0;
+    rewind->isRewinding = false;
+}
+
+void RecordRewindTick(PongRewind *rewind, const GameState *pong)
+{
+    rewind->isRewinding = false;
+    rewind->scrubTicks = 0;
+    if (rewind->capacity == 0 || ++rewind->ticksSinceSnapshot < REWIND_TICKS_PER_SNAPSHOT)
+        return;
+
+    rewind->ticksSinceSnapshot = 0;
+    rewind->snapshots[rewind->head] = TakePongSnapshot(pong);
+    rewind->head = (rewind->head + 1) % rewind->capacity;
+    if (rewind->count < rewind->capacity)
+        rewind->count++;
+}
+
+bool RewindPong(PongRewind *rewind, GameState *pong, int stepCount)
+{
+    rewind->isRewinding = true;
+    rewind->scrubTicks += stepCount;
+
+    // Newest first, each one is taken out of the ring as it's restored,
+    // so letting go records from there
+    while (rewind->scrubTicks >= REWIND_TICKS_PER_SNAPSHOT && rewind->count > 0)
+    {
+        rewind->scrubTicks -= REWIND_TICKS_PER_SNAPSHOT;
+        rewind->head = (rewind->head + rewind->capacity - 1) % rewind->capacity;
+        rewind->count--;
+        RestorePongSnapshot(pong, &rewind->snapshots[rewind->head]);
+    }
+    rewind->ticksSinceSnapshot = 0;
+
+    if (rewind->count == 0)
+    {
+        rewind->scrubTicks = 0;
+        return false;
+    }
+
+    return true;
+}
+
+void DrawRewindIndicator(const PongRewind *rewind)
+{
+    if (!rewind->isRewinding)
+        return;
+
+    // Lower left, across from the difficulty text
+    const char *text = (rewind->count > 0) ? "<< REWIND" : "<< REWIND (no more)";
+    int textLength = MeasureTextCached(text, DIFFICULTY_FONT_SIZE);
+    RenderText(text, RENDER_WIDTH / 4 - textLength / 2, RENDER_HEIGHT - (DIFFICULTY_FONT_SIZE * 2),
+               DIFFICULTY_FONT_SIZE, RAYWHITE);
+}
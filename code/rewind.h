@@ -0,0 +1,44 @@
+// EXPLANATION:
+// Hold R during a match to scrub back through the last few seconds
+// A PongSnapshot is saved every few steps into a ring that's allocated once at
+// startup (see REWIND_SECONDS and --rewind-seconds), so recording costs nothing
+// per frame, and the oldest snapshots are overwritten once it's full
+// Rewinding goes back in time at the same speed the game plays, and the match
+// carries on from wherever it's let go. Not used for replays or netplay,
+// since both need every step to play out from the inputs
+
+#ifndef PONG_REWIND_HEADER_GUARD
+#define PONG_REWIND_HEADER_GUARD
+
+#include <stdbool.h>
+#include "states.h"
+#include "snapshot.h"
+
+// Macros
+// --------------------------------------------------------------------------------
+#define REWIND_TICKS_PER_SNAPSHOT 4 // 60 snapshots a second at SIM_TICK_RATE 240
+#define REWIND_MAX_SECONDS 600      // 1.8 MB of snapshots
+
+// Types and Structures
+// --------------------------------------------------------------------------------
+typedef struct PongRewind
+{
+    PongSnapshot *snapshots; // Ring, oldest overwritten first
+    int capacity; // 0 when rewinding is off
+    int count;
+    int head; // Where the next snapshot goes
+    int ticksSinceSnapshot;
+    int scrubTicks; // Steps of rewinding not yet taken back
+    bool isRewinding; // This frame went back instead of forward
+} PongRewind;
+
+// Prototypes
+// --------------------------------------------------------------------------------
+PongRewind InitRewind(float seconds); // Allocates room for this much gameplay, 0 turns rewinding off
+void FreeRewind(PongRewind *rewind);
+void ClearRewind(PongRewind *rewind); // Forgets every snapshot, for a new match
+void RecordRewindTick(PongRewind *rewind, const GameState *pong); // Call once per step, after StepPong()
+bool RewindPong(PongRewind *rewind, GameState *pong, int stepCount); // Goes back stepCount steps (as close as the snapshots allow), false once there's nothing left
+void DrawRewindIndicator(const PongRewind *rewind);
+
+#endif // PONG_REWIND_HEADER_GUARD
@@ -0,0 +1,44 @@
+// EXPLANATION:
+// Small random number generator owned by each game
+// See rng.h for more documentation/descriptions
+
+#include "rng.h"
+
+#define PCG_MULTIPLIER 6364136223846793005ULL
+
+PongRng InitPongRng(uint32_t seed, uint32_t stream)
+{
+    // Seeding procedure from the reference implementation
+    PongRng rng = { 0, ((uint64_t)stream << 1) | 1u }; // increment must be odd
+    NextPongRng(&rng);
+    rng.state += seed;
+    NextPongRng(&rng);
+
+    return rng;
+}
+
+uint32_t NextPongRng(PongRng *rng)
+{
+    uint64_t oldState = rng->state;
+    rng->state = oldState * PCG_MULTIPLIER + rng->increment;
+
+    // Output is a permutation of the old state: xorshift, then a random rotation
+    uint32_t xorShifted = (uint32_t)(((oldState >> 18) ^ oldState) >> 27);
+    uint32_t rotation = (uint32_t)(oldState >> 59);
+    return (xorShifted >> rotation) | (xorShifted << ((32 - rotation) & 31));
+}
+
+int GetPongRngValue(PongRng *rng, int min, int max)
+{
+    if (min > max)
+    {
+        int temp = min;
+        min = max;
+        max = temp;
+    }
+
+    // Scale into the range with a multiply instead of a modulo, which is faster
+    // and just as even for ranges this small
+    uint64_t range = (uint64_t)((int64_t)max - min) + 1;
+    return (int)((int64_t)min + (int64_t)(((uint64_t)NextPongRng(rng) * range) >> 32));
+}
@@ -0,0 +1,19 @@
+// EXPLANATION:
+// Small random number generator owned by each game, instead of raylib's global one
+// A match seeded the same way always plays out the same, and separate matches
+// can run on separate threads without sharing anything
+// This is PCG32 (https://www.pcg-random.org), 16 bytes of state per generator
+
+#ifndef PONG_RNG_HEADER_GUARD
+#define PONG_RNG_HEADER_GUARD
+
+#include <stdint.h>
+#include "states.h" // for PongRng
+
+// Prototypes
+// --------------------------------------------------------------------------------
+PongRng InitPongRng(uint32_t seed, uint32_t stream); // Different streams give unrelated sequences for the same seed
+uint32_t NextPongRng(PongRng *rng); // Next 32 random bits
+int GetPongRngValue(PongRng *rng, int min, int max); // Like GetRandomValue(), min and max are included
+
+#endif // PONG_RNG_HEADER_GUARD
@@ -0,0 +1,232 @@
+// EXPLANATION:
+// Compact copies of a match's simulation state
+// See snapshot.h for more documentation/descriptions
+
+#include "snapshot.h"
+
+#include <string.h> // for memcpy()
+#include "raylib.h"
+
+#include "pong.h" // for SetGameDifficulty()
+
+// Fails to compile if a field is added without updating PONG_SNAPSHOT_WORDS, or if there's padding
+typedef char PongSnapshotSizeCheck[(sizeof(PongSnapshot) == PONG_SNAPSHOT_SIZE) ? 1 : -1];
+
+// Local Functions Declaration
+// --------------------------------------------------------------------------------
+static void TakePaddleSnapshot(PaddleSnapshot *snapshot, const Paddle *paddle);
+static void RestorePaddleSnapshot(Paddle *paddle, const PaddleSnapshot *snapshot);
+static void WriteSnapshotWord(unsigned char *data, uint32_t word);
+static uint32_t ReadSnapshotWord(const unsigned char *data);
+
+PongSnapshot TakePongSnapshot(const GameState *pong)
+{
+    PongSnapshot snapshot = { 0 };
+    snapshot.version = PONG_SNAPSHOT_VERSION;
+
+    snapshot.flags = (uint32_t)pong->currentMode | ((uint32_t)pong->difficulty << SNAPSHOT_DIFFICULTY_SHIFT);
+    if (pong->leftSideServe) snapshot.flags |= SNAPSHOT_LEFT_SIDE_SERVE;
+    if (pong->playerWon)     snapshot.flags |= SNAPSHOT_PLAYER_WON;
+    if (pong->isPaused)      snapshot.flags |= SNAPSHOT_PAUSED;
+    if (pong->textFadingOut) snapshot.flags |= SNAPSHOT_TEXT_FADING_OUT;
+
+    snapshot.rng[0] = (uint32_t)pong->rng.state;
+    snapshot.rng[1] = (uint32_t)(pong->rng.state >> 32);
+    snapshot.rng[2] = (uint32_t)pong->rng.increment;
+    snapshot.rng[3] = (uint32_t)(pong->rng.increment >> 32);
+
+    snapshot.ballX = pong->ball.position.x;
+    snapshot.ballY = pong->ball.position.y;
+    snapshot.ballDirectionX = pong->ball.direction.x;
+    snapshot.ballDirectionY = pong->ball.direction.y;
+    snapshot.ballSpeed = pong->ball.speed;
+    snapshot.paddleHits = pong->ball.paddleHits;
+    snapshot.trajectoryId = pong->ball.trajectoryId;
+
+    TakePaddleSnapshot(&snapshot.paddles[0], &pong->paddleL);
+    TakePaddleSnapshot(&snapshot.paddles[1], &pong->paddleR);
+
+    snapshot.scores = ((uint32_t)pong->scoreL & 0xffff) | ((uint32_t)pong->scoreR << 16);
+    snapshot.textFade = pong->textFade;
+    snapshot.winTimer = pong->winTimer;
+    snapshot.scoreTimer = pong->scoreTimer;
+
+    return snapshot;
+}
+
+void RestorePongSnapshot(GameState *pong, const PongSnapshot *snapshot)
+{
+    pong->currentMode = (GameMode)(snapshot->flags & SNAPSHOT_MODE_MASK);
+    GameDifficulty difficulty = (GameDifficulty)((snapshot->flags >> SNAPSHOT_DIFFICULTY_SHIFT) & 0x03);
+    if (difficulty != pong->difficulty)
+        SetGameDifficulty(pong, difficulty); // otherwise the AI stays, it may be tuned by hand
+    pong->leftSideServe = (snapshot->flags & SNAPSHOT_LEFT_SIDE_SERVE) != 0;
+    pong->playerWon = (snapshot->flags & SNAPSHOT_PLAYER_WON) != 0;
+    pong->isPaused = (snapshot->flags & SNAPSHOT_PAUSED) != 0;
+    pong->textFadingOut = (snapshot->flags & SNAPSHOT_TEXT_FADING_OUT) != 0;
+
+    pong->rng.state = (uint64_t)snapshot->rng[0] | ((uint64_t)snapshot->rng[1] << 32);
+    pong->rng.increment = (uint64_t)snapshot->rng[2] | ((uint64_t)snapshot->rng[3] << 32);
+
+    pong->ball.position = (Vector2){ snapshot->ballX, snapshot->ballY };
+    pong->ball.direction = (Vector2){ snapshot->ballDirectionX, snapshot->ballDirectionY };
+    pong->ball.speed = snapshot->ballSpeed;
+    pong->ball.paddleHits = snapshot->paddleHits;
+    pong->ball.trajectoryId = snapshot->trajectoryId;
+
+    RestorePaddleSnapshot(&pong->paddleL, &snapshot->paddles[0]);
+    RestorePaddleSnapshot(&pong->paddleR, &snapshot->paddles[1]);
+
+    pong->scoreL = (int)(snapshot->scores & 0xffff);
+    pong->scoreR = (int)(snapshot->scores >> 16);
+    pong->textFade = snapshot->textFade;
+    pong->winTimer = snapshot->winTimer;
+    pong->scoreTimer = snapshot->scoreTimer;
+}
+
+bool SavePongSnapshot(const PongSnapshot *snapshot, const char *fileName)
+{
+    unsigned char data[PONG_SNAPSHOT_SIZE];
+    WritePongSnapshot(snapshot, data);
+
+    bool saved = SaveFileData(fileName, data, PONG_SNAPSHOT_SIZE);
+    if (!saved)
+        TraceLog(LOG_WARNING, "SNAPSHOT: [%s] Could not be saved", fileName);
+
+    return saved;
+}
+
+bool LoadPongSnapshot(PongSnapshot *snapshot, const char *fileName)
+{
+    int fileSize = 0;
+    unsigned char *fileData = LoadFileData(fileName, &fileSize);
+    if (fileData == NULL)
+        return false;
+
+    bool loaded = ReadPongSnapshot(snapshot, fileData, fileSize);
+    if (!loaded)
+        TraceLog(LOG_WARNING, "SNAPSHOT: [%s] Not a version %i snapshot", fileName, PONG_SNAPSHOT_VERSION);
+    UnloadFileData(fileData);
+
+    return loaded;
+}
+
+void WritePongSnapshot(const PongSnapshot *snapshot, unsigned char *data)
+{
+    uint32_t words[PONG_SNAPSHOT_WORDS];
+    memcpy(words, snapshot, PONG_SNAPSHOT_SIZE);
+    for (int i = 0; i < PONG_SNAPSHOT_WORDS; i++)
+        WriteSnapshotWord(&data[i * 4], words[i]);
+}
+
+bool ReadPongSnapshot(PongSnapshot *snapshot, const unsigned char *data, int size)
+{
+    if (size != PONG_SNAPSHOT_SIZE || ReadSnapshotWord(data) != PONG_SNAPSHOT_VERSION)
+        return false;
+
+    uint32_t words[PONG_SNAPSHOT_WORDS];
+    for (int i = 0; i < PONG_SNAPSHOT_WORDS; i++)
+        words[i] = ReadSnapshotWord(&data[i * 4]);
+    memcpy(snapshot, words, PONG_SNAPSHOT_SIZE);
+
+    return true;
+}
+
+int EncodePongSnapshotDelta(const PongSnapshot *base, const PongSnapshot *snapshot, unsigned char *data)
+{
+    uint32_t baseWords[PONG_SNAPSHOT_WORDS];
+    uint32_t words[PONG_SNAPSHOT_WORDS];
+    memcpy(baseWords, base, PONG_SNAPSHOT_SIZE);
+    memcpy(words, snapshot, PONG_SNAPSHOT_SIZE);
+
+    uint32_t mask = 0;
+    int size = 4; // mask goes first, once it's known
+    for (int i = 0; i < PONG_SNAPSHOT_WORDS; i++)
+    {
+        uint32_t change = words[i] ^ baseWords[i];
+        if (change == 0)
+            continue;
+
+        mask |= 1u << i;
+        do
+        {
+            unsigned char byte = change & 0x7f;
+            change >>= 7;
+            data[size++] = (change != 0) ? (byte | 0x80) : byte;
+        } while (change != 0);
+    }
+    WriteSnapshotWord(data, mask);
+
+    return size;
+}
+
+bool DecodePongSnapshotDelta(PongSnapshot *snapshot, const PongSnapshot *base, const unsigned char *data, int size)
+{
+    if (size < 4)
+        return false;
+    uint32_t mask = ReadSnapshotWord(data);
+    if ((mask >> PONG_SNAPSHOT_WORDS) != 0)
+        return false;
+
+    uint32_t words[PONG_SNAPSHOT_WORDS];
+    memcpy(words, base, PONG_SNAPSHOT_SIZE);
+
+    int position = 4;
+    for (int i = 0; i < PONG_SNAPSHOT_WORDS; i++)
+    {
+        if ((mask & (1u << i)) == 0)
+            continue;
+
+        uint32_t change = 0;
+        for (int shift = 0; ; shift += 7)
+        {
+            if (position >= size || shift > 28)
+                return false;
+            unsigned char byte = data[position++];
+            change |= (uint32_t)(byte & 0x7f) << shift;
+            if ((byte & 0x80) == 0)
+                break;
+        }
+        words[i] ^= change;
+    }
+    if (position != size)
+        return false;
+
+    memcpy(snapshot, words, PONG_SNAPSHOT_SIZE);
+    return true;
+}
+
+static void TakePaddleSnapshot(PaddleSnapshot *snapshot, const Paddle *paddle)
+{
+    snapshot->y = paddle->position.y;
+    snapshot->speed = paddle->speed;
+    snapshot->nextHitPos = paddle->nextHitPos;
+    snapshot->predictionId = paddle->predictionId;
+    snapshot->targetY = paddle->targetY;
+    snapshot->nextTargetY = paddle->nextTargetY;
+    snapshot->reactionTimer = paddle->reactionTimer;
+}
+
+static void RestorePaddleSnapshot(Paddle *paddle, const PaddleSnapshot *snapshot)
+{
+    paddle->position.y = snapshot->y;
+    paddle->speed = snapshot->speed;
+    paddle->nextHitPos = snapshot->nextHitPos;
+    paddle->predictionId = snapshot->predictionId;
+    paddle->targetY = snapshot->targetY;
+    paddle->nextTargetY = snapshot->nextTargetY;
+    paddle->reactionTimer = snapshot->reactionTimer;
+}
+
+static void WriteSnapshotWord(unsigned char *data, uint32_t word)
+{
+    data[0] = (unsigned char)word;
+    data[1] = (unsigned char)(word >> 8);
+    data[2] = (unsigned char)(word >> 16);
+    data[3] = (unsigned char)(word >> 24);
+}
+
+static uint32_t ReadSnapshotWord(const unsigned char *data)
+{
+    return (uint32_t)data[0] | ((uint32_t)data[1] << 8) | ((uint32_t)data[2] << 16) | ((uint32_t)data[3] << 24);
+}
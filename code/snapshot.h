@@ -0,0 +1,78 @@
+// EXPLANATION:
+// Compact copies of a match's simulation state, for rollback, rewinding and search
+// A snapshot only has what changes during a match (ball, paddles, scores, timers and
+// the random number generator), not the sounds, config, screen or paddle sizes,
+// so it's 124 bytes instead of a whole GameState and thousands fit in cache
+// Restoring one gives back exactly the game it was taken from, down to the last bit
+//
+// Every field is 4 bytes, so a snapshot can be handled as an array of words:
+// saved as little endian words with the version first, and delta encoded as a
+// mask of the words that changed, then each changed word XORed with the old one
+// as a varint (7 bits per byte), so small float changes take 2-3 bytes
+
+#ifndef PONG_SNAPSHOT_HEADER_GUARD
+#define PONG_SNAPSHOT_HEADER_GUARD
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "states.h"
+
+// Macros
+// --------------------------------------------------------------------------------
+#define PONG_SNAPSHOT_VERSION 1
+#define PONG_SNAPSHOT_WORDS 31
+#define PONG_SNAPSHOT_SIZE (PONG_SNAPSHOT_WORDS * 4) // Bytes, saved or in memory
+#define PONG_SNAPSHOT_MAX_DELTA_SIZE (4 + PONG_SNAPSHOT_WORDS * 5) // Every word changed
+
+// Snapshot flags
+#define SNAPSHOT_MODE_MASK        0x03 // GameMode
+#define SNAPSHOT_DIFFICULTY_SHIFT 2    // GameDifficulty, 2 bits
+#define SNAPSHOT_LEFT_SIDE_SERVE  0x10
+#define SNAPSHOT_PLAYER_WON       0x20
+#define SNAPSHOT_PAUSED           0x40
+#define SNAPSHOT_TEXT_FADING_OUT  0x80
+
+// Types and Structures
+// --------------------------------------------------------------------------------
+typedef struct PaddleSnapshot // Position x, size and AI tuning are set per match, so they're left out
+{
+    float y;
+    float speed;
+    float nextHitPos;
+    uint32_t predictionId;
+    float targetY;
+    float nextTargetY;
+    float reactionTimer;
+} PaddleSnapshot;
+
+typedef struct PongSnapshot
+{
+    uint32_t version; // PONG_SNAPSHOT_VERSION
+    uint32_t flags;   // SNAPSHOT_* bits
+    uint32_t rng[4];  // State then increment, low words first
+    float ballX;
+    float ballY;
+    float ballDirectionX;
+    float ballDirectionY;
+    float ballSpeed;
+    int32_t paddleHits;
+    uint32_t trajectoryId;
+    PaddleSnapshot paddles[2]; // Left, right
+    uint32_t scores; // Left in the low 16 bits, right in the high
+    float textFade;
+    float winTimer;
+    float scoreTimer;
+} PongSnapshot;
+
+// Prototypes
+// --------------------------------------------------------------------------------
+PongSnapshot TakePongSnapshot(const GameState *pong);
+void RestorePongSnapshot(GameState *pong, const PongSnapshot *snapshot); // The game needs the same config, and keeps its computer AI unless the difficulty changes
+bool SavePongSnapshot(const PongSnapshot *snapshot, const char *fileName);
+bool LoadPongSnapshot(PongSnapshot *snapshot, const char *fileName); // Fails on other versions
+void WritePongSnapshot(const PongSnapshot *snapshot, unsigned char *data); // PONG_SNAPSHOT_SIZE bytes
+bool ReadPongSnapshot(PongSnapshot *snapshot, const unsigned char *data, int size);
+int EncodePongSnapshotDelta(const PongSnapshot *base, const PongSnapshot *snapshot, unsigned char *data); // Bytes written, at most PONG_SNAPSHOT_MAX_DELTA_SIZE
+bool DecodePongSnapshotDelta(PongSnapshot *snapshot, const PongSnapshot *base, const unsigned char *data, int size);
+
+#endif // PONG_SNAPSHOT_HEADER_GUARD
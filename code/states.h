@@ -4,6 +4,7 @@
 #ifndef PONG_STATES_HEADER_GUARD
 #define PONG_STATES_HEADER_GUARD
 
+#include <stdint.h> // for uint32_t and uint64_t
 #include "raylib.h"
 
 // Pong Game
@@ -26,14 +27,36 @@ typedef enum GameDifficulty // Multiplier for CPU paddle speed
 
 typedef enum PongBeep
 {
-    BEEP_MENU, BEEP_PADDLE, BEEP_EDGE, BEEP_SCORE
+    BEEP_MENU, BEEP_PADDLE, BEEP_EDGE, BEEP_SCORE,
+    BEEP_COUNT
 } PongBeep;
 
+typedef enum ComputerHitStrategy // Where the computer tries to hit the ball on its paddle
+{
+    HIT_RANDOM, // Anywhere from edge to edge, picked after every hit
+    HIT_CENTER, // Always the center, for straight returns
+    HIT_EDGE    // Always near an edge, for the sharpest angles
+} ComputerHitStrategy;
+
+typedef struct ComputerAi // Tuning for a computer paddle
+{
+    float reactionDelay; // Seconds before reacting to a new ball path
+    float aimError; // Most pixels the computer can misjudge where the ball will be
+    float speed; // Paddle speed in pixels per second
+    float slowdownAfterHit; // Speed is divided by this while the ball moves away
+    ComputerHitStrategy hitStrategy;
+} ComputerAi;
+
 typedef struct Paddle
 {
     Vector2 position;
     float nextHitPos; // Only used for Computer paddle
-                      // Determines how the computer will angle its next bounce
+                      // Distance from the paddle's center where it will try to hit the ball next
+    ComputerAi ai;    // Only used for Computer paddle
+    unsigned int predictionId; // Only used for Computer paddle, ball trajectory that targetY was predicted for
+    float targetY;             // Height the computer is moving towards (ball center)
+    float nextTargetY;         // Prediction waiting for the reaction delay to pass
+    float reactionTimer;
     float speed;
     int length;
     int width;
@@ -45,12 +68,101 @@ typedef struct Ball
     Vector2 direction;
     float speed; // the ball is always set to this speed
     int size;
+    int paddleHits; // total paddle hits this match, used for rally stats
+    unsigned int trajectoryId; // changes whenever a serve or paddle hit sets a new path
 } Ball;
 
+typedef struct PongRng // Random number generator state, see rng.h
+{
+    uint64_t state;
+    uint64_t increment;
+} PongRng;
+
+#define AUDIO_QUEUE_SIZE 64 // Beeps waiting for the mixer, power of two
+
+typedef struct AudioEvent // Sent from the game to the mixer, see audio.h
+{
+    PongBeep beep;
+    float pitch; // Frequency multiplier, 1 for the beep's own tone
+} AudioEvent;
+
+typedef enum AudioStage // ADSR envelope stages, in order
+{
+    AUDIO_STAGE_OFF, AUDIO_STAGE_ATTACK, AUDIO_STAGE_DECAY, AUDIO_STAGE_SUSTAIN, AUDIO_STAGE_RELEASE
+} AudioStage;
+
+typedef struct AudioVoice // One playing beep, only touched by the mixer
+{
+    uint32_t phase; // Phase accumulator, a full turn wraps around 2^32
+    uint32_t phaseStep; // Per sample
+    float envelope; // Current level, 0 to 1
+    float envelopeStep; // Per sample, for this stage
+    AudioStage stage; // Silent when off
+    int stageFrames; // Samples left in this stage
+} AudioVoice;
+
+typedef struct PongAudio // Beeps are synthesized as they play, games only keep a pointer
+{
+    AudioStream stream;
+    bool isReady; // The stream is playing
+
+    // Single producer (the game), single consumer (the mixer), no locks
+    // Each index is only written by its own side, and both only ever count up
+    AudioEvent queue[AUDIO_QUEUE_SIZE];
+    unsigned int queueHead; // Next event to write, game side
+    unsigned int queueTail; // Next event to read, mixer side
+    unsigned int droppedEvents; // Queue was full, game side
+
+    AudioVoice voices[BEEP_COUNT]; // A beep played again restarts, like a raylib Sound
+} PongAudio;
+
+typedef struct Playfield // Field lines never move, so they're drawn once at startup
+{
+    RenderTexture2D plain;
+    RenderTexture2D textGap; // Center line cut where the pause and demo text go
+} Playfield;
+
+typedef struct PongInput // Player input for the simulation, gathered once per rendered frame
+{
+    float moveL; // Paddle movement: -1 is up, 1 is down, doubled when speeding up
+    float moveR;
+    float mouseY; // Mouse height in render coordinates
+    bool mouseMoved;   // The fields below are presses, only applied on one step
+    bool pausePressed;
+    bool skipPressed;  // Skip the win screen
+} PongInput;
+
+// Every setting that can change from match to match: type, name, default (see pong.h), lowest and highest allowed
+// The config struct, its defaults and the config file loader all come from this list
+#define PONG_CONFIG_FIELDS(X) \
+    X(int,   winScore,                WIN_SCORE,                 1,    999) \
+    X(int,   paddleLength,            PADDLE_LENGTH,             1,    RENDER_HEIGHT) \
+    X(int,   paddleWidth,             PADDLE_WIDTH,              1,    RENDER_WIDTH / 4) \
+    X(float, paddleSpeed,             PADDLE_SPEED,              0,    100000) \
+    X(int,   ballSize,                BALL_SIZE,                 1,    RENDER_HEIGHT / 4) \
+    X(float, ballSpeed,               BALL_SPEED,                1,    100000) \
+    X(float, bounceMultiplier,        BOUNCE_MULTIPLIER,         0.5,  2) \
+    X(float, paddleHitMaxAngle,       PADDLE_HIT_MAX_ANGLE,      0,    89) \
+    X(float, minimumVerticalAngle,    MINIMUM_VERTICAL_ANGLE,    1,    89) \
+    X(int,   returnPositionVariation, RETURN_POSITION_VARIATION, 0,    RENDER_HEIGHT / 2) \
+    X(int,   returnAngleVariation,    RETURN_ANGLE_VARIATION,    0,    10000) \
+    X(float, scorePauseTime,          SCORE_PAUSE_TIME,          0,    60) \
+    X(float, winPauseTime,            WIN_PAUSE_TIME,            0,    60)
+
+typedef struct PongConfig // Rules and physics for a match, see LoadPongConfig()
+{
+    #define PONG_CONFIG_MEMBER(type, name, defaultValue, lowest, highest) type name;
+    PONG_CONFIG_FIELDS(PONG_CONFIG_MEMBER)
+    #undef PONG_CONFIG_MEMBER
+    float minimumVerticalSin; // Worked out from minimumVerticalAngle
+} PongConfig;
+
 typedef struct GameState
 {
     ScreenState currentScreen;
-    Sound beeps[4];
+    PongAudio *audio; // shared by every game, owned by main(), NULL for no sound
+    const PongConfig *config; // never NULL, owned by whoever started the game
+    PongRng rng; // every random choice in the game comes from here
     Ball ball;
     Paddle paddleL;
     Paddle paddleR;
@@ -63,6 +175,7 @@ typedef struct GameState
     bool isPaused;
     bool gameShouldExit;       // flag to tell the game window to close
     float textFade;            // tracks fade value over time
+    bool textFadingOut;        // direction of the fade animation
     float textFadeTimeElapsed; // tracks time for the fade animation
     float winTimer;            // countdown after player wins
     float scoreTimer;          // countdown after a score
@@ -71,6 +184,8 @@ typedef struct GameState
 // User Interface
 // --------------------------------------------------------------------------------
 
+#define UI_MAX_BUTTONS 4 // Per menu, the most any menu has
+
 typedef enum UiMenuId { MENU_TITLE, MENU_DIFFICULTY } UiMenuId;
 
 typedef enum UiOptionId
@@ -89,11 +204,12 @@ typedef struct UiButton // Holds data for a menu button
     int fontSize;
     Vector2 position;
     Color color;
+    Rectangle bounds; // Clickable area, set when the button is made
 } UiButton;
 
 typedef struct UiMenu // Holds data for a menu of buttons
 {
-    UiButton *buttons;
+    UiButton buttons[UI_MAX_BUTTONS]; // Stored inline, so menus can be rebuilt without touching the heap
     unsigned int buttonCount;
 } UiMenu;
 
@@ -107,6 +223,7 @@ typedef struct UiState // Holds data for the title screen menu
     float keyHeldTime;
     bool firstFrame; // used for mouse selection
     bool autoScroll;
+    bool needsRedraw; // the menu changed since it was last drawn
 } UiState;
 
 #endif // PONG_STATES_HEADER_GUARD
@@ -0,0 +1,585 @@
+// EXPLANATION:
+// Microbenchmarks for the game's hot paths: ball and paddle updates, collisions,
+// the computer AI, game resets, snapshots, batched matches, training environments, the audio mixer and the title menu
+// Each benchmark runs in samples of many calls, and the time per call is reported
+// as the mean and percentiles over all samples, along with heap allocations per call
+// Use --json to save results that can be compared across commits
+//
+// Usage: pong_bench [--json] [name filter]
+
+#include <math.h> // for sinf() and cosf(), to compare against the paddle hit table
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "raylib.h"
+#include "platform.h" // for GetWallTime(), raylib's GetTime() needs a window
+#include "config.h" // for RENDER_WIDTH and RENDER_HEIGHT
+#include "pong.h"
+#include "ui.h"
+#include "batch.h"
+#include "env.h"
+#include "snapshot.h"
+
+// Macros
+// --------------------------------------------------------------------------------
+#define BENCH_SAMPLES 200          // Timed samples per benchmark
+#define BENCH_SAMPLE_TIME 0.0002   // Each sample repeats the call until it takes at least this long (seconds)
+#define BENCH_MAX_ITERATIONS (1 << 24)
+#define BENCH_ENV_COUNT 1024       // Environments stepped per StepPongEnv() call
+#define BENCH_BATCH_COUNT 1024     // Matches stepped per StepPongBatch() call
+#define BENCH_AUDIO_FRAMES AUDIO_BUFFER_FRAMES // Samples mixed per MixPongAudio() call
+
+// Heap allocations can only be counted where malloc can be replaced, see the bottom of this file
+#if defined(__GLIBC__)
+    #define BENCH_COUNT_ALLOCATIONS
+#endif
+
+// Types and Structures
+// --------------------------------------------------------------------------------
+typedef struct BenchData // Shared by every benchmark, each one sets up the parts it uses
+{
+    GameState pong;
+    UiState ui;
+    Vector2 mousePositions[16];
+    PongSnapshot snapshots[2]; // A demo match a step apart
+    unsigned char snapshotDelta[PONG_SNAPSHOT_MAX_DELTA_SIZE]; // From the first snapshot to the second
+    int snapshotDeltaSize;
+    PongBatch batch; // BENCH_BATCH_COUNT matches, computer against computer
+    PongEnv env; // BENCH_ENV_COUNT environments against the computer
+    float envActions[BENCH_ENV_COUNT];
+    PongAudio audio; // Mixed by hand, there's no audio device
+    short audioSamples[BENCH_AUDIO_FRAMES];
+    volatile int sink; // Keeps results from being optimized away
+} BenchData;
+
+typedef struct Benchmark
+{
+    const char *name;
+    void (*run)(BenchData *data, int iterations);
+    bool needsFont; // MeasureText() returns 0 without a window
+} Benchmark;
+
+typedef struct BenchResult
+{
+    int iterations; // Calls per sample
+    double meanNs; // All times are per call
+    double minNs;
+    double p50Ns;
+    double p90Ns;
+    double p99Ns;
+    double allocations; // Per call, negative if they can't be counted
+    double allocatedBytes;
+} BenchResult;
+
+// Local Functions Declaration
+// --------------------------------------------------------------------------------
+static int CompareDoubles(const void *a, const void *b);
+static BenchResult RunBenchmark(const Benchmark *bench, BenchData *data);
+static void PrintResultsTable(const Benchmark *benches, const BenchResult *results, const bool *selected, int count);
+static void PrintResultsJson(const Benchmark *benches, const BenchResult *results, const bool *selected, int count, bool hasFont);
+
+// Benchmarks
+static void BenchUpdateBall(BenchData *data, int iterations);
+static void BenchBounceBallEdge(BenchData *data, int iterations);
+static void BenchBounceBallPaddle(BenchData *data, int iterations);
+static void BenchUpdatePaddleComputer(BenchData *data, int iterations);
+static void BenchUpdatePaddleComputerPredict(BenchData *data, int iterations);
+static void BenchStepPong(BenchData *data, int iterations);
+static void BenchInitGameState(BenchData *data, int iterations);
+static void BenchTakePongSnapshot(BenchData *data, int iterations);
+static void BenchRestorePongSnapshot(BenchData *data, int iterations);
+static void BenchEncodePongSnapshotDelta(BenchData *data, int iterations);
+static void BenchDecodePongSnapshotDelta(BenchData *data, int iterations);
+static void BenchGetPaddleHitDirection(BenchData *data, int iterations);
+static void BenchPaddleHitDirectionTrig(BenchData *data, int iterations);
+static void BenchStepPongBatch(BenchData *data, int iterations);
+static void BenchStepPongEnv(BenchData *data, int iterations);
+static void BenchMixPongAudio(BenchData *data, int iterations);
+static void BenchPlayBeep(BenchData *data, int iterations);
+static void BenchInitUiState(BenchData *data, int iterations);
+static void BenchIsMouseWithinButton(BenchData *data, int iterations);
+static void BenchMeasureTextCached(BenchData *data, int iterations);
+
+// Local Variables Definition
+// --------------------------------------------------------------------------------
+static const Benchmark benchmarks[] = {
+    { "UpdateBall",                      BenchUpdateBall,                  false },
+    { "BounceBallEdge",                  BenchBounceBallEdge,              false },
+    { "BounceBallPaddle",                BenchBounceBallPaddle,            false },
+    { "UpdatePaddleComputer",            BenchUpdatePaddleComputer,        false },
+    { "UpdatePaddleComputer/predict",    BenchUpdatePaddleComputerPredict, false },
+    { "StepPong/demo",                   BenchStepPong,                    false },
+    { "InitGameState",                   BenchInitGameState,               false },
+    { "TakePongSnapshot",                BenchTakePongSnapshot,            false },
+    { "RestorePongSnapshot",             BenchRestorePongSnapshot,         false },
+    { "EncodePongSnapshotDelta",         BenchEncodePongSnapshotDelta,     false },
+    { "DecodePongSnapshotDelta",         BenchDecodePongSnapshotDelta,     false },
+    { "GetPaddleHitDirection",           BenchGetPaddleHitDirection,       false },
+    { "GetPaddleHitDirection/sinf",      BenchPaddleHitDirectionTrig,      false },
+    { "StepPongBatch/1024",              BenchStepPongBatch,               false },
+    { "StepPongEnv/1024",                BenchStepPongEnv,                 false },
+    { "MixPongAudio/512",                BenchMixPongAudio,                false },
+    { "PlayBeep",                        BenchPlayBeep,                    false },
+    { "InitUiState",                     BenchInitUiState,                 true },
+    { "IsMouseWithinButton",             BenchIsMouseWithinButton,         true },
+    { "MeasureTextCached",               BenchMeasureTextCached,           true },
+};
+
+#if defined(BENCH_COUNT_ALLOCATIONS)
+static unsigned long long allocationCount = 0;
+static unsigned long long allocatedBytes = 0;
+#endif
+
+int main(int argc, char **argv)
+{
+    bool outputJson = false;
+    const char *filter = NULL;
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--json") == 0)
+            outputJson = true;
+        else
+            filter = argv[i];
+    }
+
+    const int benchCount = (int)(sizeof(benchmarks) / sizeof(benchmarks[0]));
+    bool selected[sizeof(benchmarks) / sizeof(benchmarks[0])];
+    bool needsFont = false;
+    for (int i = 0; i < benchCount; i++)
+    {
+        selected[i] = (filter == NULL) || (strstr(benchmarks[i].name, filter) != NULL);
+        needsFont |= selected[i] && benchmarks[i].needsFont;
+    }
+
+    SetTraceLogLevel(LOG_ERROR); // keep raylib's info logs out of the results
+
+    // The default font only exists once a window is open, so use a hidden one
+    // Without a display this fails, and text is measured as 0 pixels wide
+    bool hasFont = false;
+    if (needsFont)
+    {
+        SetConfigFlags(FLAG_WINDOW_HIDDEN);
+        InitWindow(320, 240, "pong_bench");
+        hasFont = IsWindowReady();
+        if (!hasFont)
+            fprintf(stderr, "No window available, UI benchmarks run without the default font\n");
+    }
+
+    BenchData data = { 0 };
+    data.pong = InitGameState(1, NULL, NULL);
+    data.ui = InitUiState();
+    data.batch = InitPongBatch(BENCH_BATCH_COUNT, 1, NULL);
+    SetPongBatchDifficulty(&data.batch, DIFFICULTY_HARD);
+    data.env = InitPongEnv(BENCH_ENV_COUNT, 1, true, DIFFICULTY_MEDIUM, NULL);
+    // A few seconds into a demo match, so the ball and paddles are moving
+    GameState demo = InitGameState(1, NULL, NULL);
+    StartPongMatch(&demo, MODE_DEMO, DIFFICULTY_MEDIUM, 1);
+    PongInput noInput = { 0 };
+    for (int i = 0; i < SIM_TICK_RATE * 3; i++)
+        StepPong(&demo, &noInput, SIM_TIMESTEP);
+    data.snapshots[0] = TakePongSnapshot(&demo);
+    StepPong(&demo, &noInput, SIM_TIMESTEP);
+    data.snapshots[1] = TakePongSnapshot(&demo);
+    data.snapshotDeltaSize = EncodePongSnapshotDelta(&data.snapshots[0], &data.snapshots[1], data.snapshotDelta);
+    for (int i = 0; i < 16; i++)
+        data.mousePositions[i] = (Vector2){ (float)(i * 97 % RENDER_WIDTH), (float)(i * 71 % RENDER_HEIGHT) };
+
+    BenchResult results[sizeof(benchmarks) / sizeof(benchmarks[0])] = { 0 };
+    for (int i = 0; i < benchCount; i++)
+    {
+        if (!selected[i])
+            continue;
+        if (!outputJson)
+            fprintf(stderr, "Running %s...\n", benchmarks[i].name);
+        results[i] = RunBenchmark(&benchmarks[i], &data);
+    }
+
+    if (outputJson)
+        PrintResultsJson(benchmarks, results, selected, benchCount, hasFont);
+    else
+        PrintResultsTable(benchmarks, results, selected, benchCount);
+
+    FreePongBatch(&data.batch);
+    FreePongEnv(&data.env);
+    if (hasFont)
+        CloseWindow();
+
+    return 0;
+}
+
+static int CompareDoubles(const void *a, const void *b)
+{
+    double difference = *(const double *)a - *(const double *)b;
+    return (difference > 0) - (difference < 0);
+}
+
+static BenchResult RunBenchmark(const Benchmark *bench, BenchData *data)
+{
+    BenchResult result = { 0 };
+
+    // Find how many calls make a sample long enough to time accurately
+    int iterations = 1;
+    while (iterations < BENCH_MAX_ITERATIONS)
+    {
+        double startTime = GetWallTime();
+        bench->run(data, iterations);
+        if (GetWallTime() - startTime >= BENCH_SAMPLE_TIME)
+            break;
+        iterations *= 2;
+    }
+    result.iterations = iterations;
+
+    double samples[BENCH_SAMPLES];
+    double totalNs = 0.0;
+    for (int s = 0; s < BENCH_SAMPLES; s++)
+    {
+        double startTime = GetWallTime();
+        bench->run(data, iterations);
+        samples[s] = (GetWallTime() - startTime) * 1e9 / iterations;
+        totalNs += samples[s];
+    }
+
+    qsort(samples, BENCH_SAMPLES, sizeof(double), CompareDoubles);
+    result.meanNs = totalNs / BENCH_SAMPLES;
+    result.minNs = samples[0];
+    result.p50Ns = samples[BENCH_SAMPLES * 50 / 100];
+    result.p90Ns = samples[BENCH_SAMPLES * 90 / 100];
+    result.p99Ns = samples[BENCH_SAMPLES * 99 / 100];
+
+    // Allocations are counted in a separate, untimed run
+#if defined(BENCH_COUNT_ALLOCATIONS)
+    unsigned long long startCount = allocationCount;
+    unsigned long long startBytes = allocatedBytes;
+    bench->run(data, iterations);
+    result.allocations = (double)(allocationCount - startCount) / iterations;
+    result.allocatedBytes = (double)(allocatedBytes - startBytes) / iterations;
+#else
+    result.allocations = -1.0;
+    result.allocatedBytes = -1.0;
+#endif
+
+    return result;
+}
+
+static void PrintResultsTable(const Benchmark *benches, const BenchResult *results, const bool *selected, int count)
+{
+    printf("%-30s %10s %10s %10s %10s %10s %10s %12s\n",
+           "benchmark", "mean ns", "min ns", "p50 ns", "p90 ns", "p99 ns", "allocs/op", "bytes/op");
+    for (int i = 0; i < count; i++)
+    {
+        if (!selected[i])
+            continue;
+
+        const BenchResult *r = &results[i];
+        printf("%-30s %10.1f %10.1f %10.1f %10.1f %10.1f ",
+               benches[i].name, r->meanNs, r->minNs, r->p50Ns, r->p90Ns, r->p99Ns);
+        if (r->allocations < 0)
+            printf("%10s %12s\n", "n/a", "n/a");
+        else
+            printf("%10.2f %12.1f\n", r->allocations, r->allocatedBytes);
+    }
+}
+
+static void PrintResultsJson(const Benchmark *benches, const BenchResult *results, const bool *selected, int count, bool hasFont)
+{
+    printf("{\n");
+    printf("  \"samples\": %i,\n", BENCH_SAMPLES);
+    printf("  \"font\": %s,\n", hasFont ? "true" : "false");
+    printf("  \"benchmarks\": [");
+
+    bool first = true;
+    for (int i = 0; i < count; i++)
+    {
+        if (!selected[i])
+            continue;
+
+        const BenchResult *r = &results[i];
+        printf("%s\n    { \"name\": \"%s\", \"iterations\": %i, \"mean_ns\": %.2f, \"min_ns\": %.2f, "
+               "\"p50_ns\": %.2f, \"p90_ns\": %.2f, \"p99_ns\": %.2f, ",
+               first ? "" : ",", benches[i].name, r->iterations,
+               r->meanNs, r->minNs, r->p50Ns, r->p90Ns, r->p99Ns);
+        if (r->allocations < 0)
+            printf("\"allocs_per_op\": null, \"bytes_per_op\": null }");
+        else
+            printf("\"allocs_per_op\": %.3f, \"bytes_per_op\": %.1f }", r->allocations, r->allocatedBytes);
+        first = false;
+    }
+
+    printf("\n  ]\n}\n");
+}
+
+// Benchmarks
+// --------------------------------------------------------------------------------
+static void BenchUpdateBall(BenchData *data, int iterations)
+{
+    Ball *ball = &data->pong.ball;
+    ball->speed = BALL_SPEED;
+    ball->direction = (Vector2){ 100.0f, 37.0f };
+
+    for (int i = 0; i < iterations; i++)
+    {
+        UpdateBall(ball, SIM_TIMESTEP, data->pong.config);
+
+        // Wrap around instead of flying off forever
+        if (ball->position.x > RENDER_WIDTH)
+            ball->position = (Vector2){ 0.0f, RENDER_HEIGHT / 2.0f };
+    }
+}
+
+static void BenchBounceBallEdge(BenchData *data, int iterations)
+{
+    GameState *pong = &data->pong;
+    pong->playerWon = false;
+
+    // Bounce off the top every call
+    for (int i = 0; i < iterations; i++)
+    {
+        pong->ball.position = (Vector2){ RENDER_WIDTH / 2.0f, FIELD_LINE_WIDTH - 1.0f };
+        pong->ball.direction.y = -100.0f;
+        BounceBallEdge(pong);
+    }
+}
+
+static void BenchBounceBallPaddle(BenchData *data, int iterations)
+{
+    GameState *pong = &data->pong;
+    Paddle *paddle = &pong->paddleL;
+
+    // Overlap the left paddle every call, at a different height each time
+    for (int i = 0; i < iterations; i++)
+    {
+        pong->ball.position = (Vector2){ paddle->position.x + paddle->width - 5.0f,
+                                         paddle->position.y + (float)(i % paddle->length) - BALL_SIZE / 2.0f };
+        pong->ball.direction = (Vector2){ -100.0f, 20.0f };
+        pong->ball.speed = BALL_SPEED;
+        BounceBallPaddle(&pong->ball, paddle, &pong->rng, pong->audio, pong->config);
+    }
+}
+
+static void BenchUpdatePaddleComputer(BenchData *data, int iterations)
+{
+    GameState *pong = &data->pong;
+    pong->ball.position = (Vector2){ RENDER_WIDTH / 2.0f, RENDER_HEIGHT / 3.0f };
+    pong->ball.direction = (Vector2){ 100.0f, 60.0f };
+    pong->ball.speed = BALL_SPEED;
+
+    // Same ball path every call, so the prediction is cached
+    for (int i = 0; i < iterations; i++)
+        UpdatePaddleComputer(&pong->paddleR, &pong->ball, &pong->rng, pong->config, SIM_TIMESTEP);
+}
+
+static void BenchUpdatePaddleComputerPredict(BenchData *data, int iterations)
+{
+    GameState *pong = &data->pong;
+    pong->ball.position = (Vector2){ RENDER_WIDTH / 2.0f, RENDER_HEIGHT / 3.0f };
+    pong->ball.direction = (Vector2){ 100.0f, 60.0f };
+    pong->ball.speed = BALL_SPEED;
+
+    // New ball path every call, like the step right after a paddle hit
+    for (int i = 0; i < iterations; i++)
+    {
+        pong->ball.trajectoryId++;
+        UpdatePaddleComputer(&pong->paddleR, &pong->ball, &pong->rng, pong->config, SIM_TIMESTEP);
+    }
+}
+
+static void BenchStepPong(BenchData *data, int iterations)
+{
+    GameState *pong = &data->pong;
+    pong->currentScreen = SCREEN_GAMEPLAY;
+    pong->currentMode = MODE_DEMO;
+
+    PongInput input = { 0 };
+    for (int i = 0; i < iterations; i++)
+        StepPong(pong, &input, SIM_TIMESTEP);
+}
+
+static void BenchInitGameState(BenchData *data, int iterations)
+{
+    // Every reset goes through here, so it should never allocate
+    for (int i = 0; i < iterations; i++)
+    {
+        GameState pong = InitGameState((unsigned int)i, data->pong.audio, data->pong.config);
+        data->sink += (int)pong.ball.direction.y;
+    }
+}
+
+static void BenchTakePongSnapshot(BenchData *data, int iterations)
+{
+    for (int i = 0; i < iterations; i++)
+    {
+        PongSnapshot snapshot = TakePongSnapshot(&data->pong);
+        data->sink += (int)snapshot.flags;
+    }
+}
+
+static void BenchRestorePongSnapshot(BenchData *data, int iterations)
+{
+    for (int i = 0; i < iterations; i++)
+    {
+        RestorePongSnapshot(&data->pong, &data->snapshots[i & 1]);
+        data->sink += data->pong.scoreL;
+    }
+}
+
+static void BenchEncodePongSnapshotDelta(BenchData *data, int iterations)
+{
+    unsigned char delta[PONG_SNAPSHOT_MAX_DELTA_SIZE];
+    for (int i = 0; i < iterations; i++)
+        data->sink += EncodePongSnapshotDelta(&data->snapshots[0], &data->snapshots[1], delta);
+}
+
+static void BenchDecodePongSnapshotDelta(BenchData *data, int iterations)
+{
+    PongSnapshot snapshot;
+    for (int i = 0; i < iterations; i++)
+        data->sink += DecodePongSnapshotDelta(&snapshot, &data->snapshots[0], data->snapshotDelta, data->snapshotDeltaSize);
+}
+
+static void BenchGetPaddleHitDirection(BenchData *data, int iterations)
+{
+    float sum = 0.0f;
+    for (int i = 0; i < iterations; i++)
+    {
+        float hitPosition = (float)(i % 241 - 120) / 100.0f; // -1.2 to 1.2
+        Vector2 direction = GetPaddleHitDirection(hitPosition, data->pong.config);
+        sum += direction.x + direction.y;
+    }
+
+    data->sink += (int)sum;
+}
+
+static void BenchPaddleHitDirectionTrig(BenchData *data, int iterations)
+{
+    // How bounces worked out their direction before the table, for comparison
+    float sum = 0.0f;
+    for (int i = 0; i < iterations; i++)
+    {
+        float hitPosition = (float)(i % 241 - 120) / 100.0f;
+        float angle = hitPosition * PADDLE_HIT_MAX_ANGLE * (PI / 180.0f);
+        sum += cosf(angle) + sinf(angle);
+    }
+
+    data->sink += (int)sum;
+}
+
+static void BenchStepPongBatch(BenchData *data, int iterations)
+{
+    for (int i = 0; i < iterations; i++)
+        StepPongBatch(&data->batch, SIM_TIMESTEP);
+}
+
+static void BenchStepPongEnv(BenchData *data, int iterations)
+{
+    // Follow the ball, so rallies and resets happen like they would in training
+    PongEnv *env = &data->env;
+    for (int i = 0; i < iterations; i++)
+    {
+        for (int e = 0; e < BENCH_ENV_COUNT; e++)
+        {
+            const float *observation = &env->observations[e * OBS_COUNT];
+            float paddleCenter = observation[OBS_PADDLE_L_Y] + PADDLE_LENGTH / 2.0f / RENDER_HEIGHT;
+            data->envActions[e] = (observation[OBS_BALL_Y] > paddleCenter) ? 1.0f : -1.0f;
+        }
+        StepPongEnv(env, data->envActions);
+    }
+}
+
+static void BenchMixPongAudio(BenchData *data, int iterations)
+{
+    // Every beep playing at once, the most the mixer ever has to do
+    for (int i = 0; i < iterations; i++)
+    {
+        for (int beep = 0; beep < BEEP_COUNT; beep++)
+        {
+            if (data->audio.voices[beep].stage == AUDIO_STAGE_OFF)
+                PlayBeep(&data->audio, (PongBeep)beep, 1.5f);
+        }
+        MixPongAudio(&data->audio, data->audioSamples, BENCH_AUDIO_FRAMES);
+        data->sink += data->audioSamples[0];
+    }
+}
+
+static void BenchPlayBeep(BenchData *data, int iterations)
+{
+    // What the game pays per beep, with the mixer draining the queue as it fills
+    for (int i = 0; i < iterations; i++)
+    {
+        PlayBeep(&data->audio, BEEP_PADDLE, 1.0f);
+        if ((i % (AUDIO_QUEUE_SIZE / 2)) == 0)
+            MixPongAudio(&data->audio, data->audioSamples, 1);
+    }
+}
+
+static void BenchInitUiState(BenchData *data, int iterations)
+{
+    for (int i = 0; i < iterations; i++)
+    {
+        UiState ui = InitUiState();
+        data->sink += (int)ui.menus[MENU_TITLE].buttonCount;
+    }
+}
+
+static void BenchIsMouseWithinButton(BenchData *data, int iterations)
+{
+    UiMenu *menu = &data->ui.menus[MENU_TITLE];
+    int hits = 0;
+
+    for (int i = 0; i < iterations; i++)
+    {
+        Vector2 mousePos = data->mousePositions[i & 15];
+        hits += IsMouseWithinButton(mousePos, &menu->buttons[i % menu->buttonCount]);
+    }
+
+    data->sink += hits;
+}
+
+static void BenchMeasureTextCached(BenchData *data, int iterations)
+{
+    // The HUD's text, as drawn every frame
+    static const char *texts[] = { "0", "5", "PAUSED", "DEMO MODE", "Winner", "Difficulty Medium" };
+    int width = 0;
+
+    for (int i = 0; i < iterations; i++)
+        width += MeasureTextCached(texts[i % 6], SCORE_FONT_SIZE);
+
+    data->sink += width;
+}
+
+// Allocation counting
+// --------------------------------------------------------------------------------
+// glibc lets a program replace malloc and friends, and raylib's MemAlloc() ends up
+// here too, so wrap glibc's own allocator and count every call
+#if defined(BENCH_COUNT_ALLOCATIONS)
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t count, size_t size);
+extern void *__libc_realloc(void *ptr, size_t size);
+extern void __libc_free(void *ptr);
+
+void *malloc(size_t size)
+{
+    allocationCount++;
+    allocatedBytes += size;
+    return __libc_malloc(size);
+}
+
+void *calloc(size_t count, size_t size)
+{
+    allocationCount++;
+    allocatedBytes += count * size;
+    return __libc_calloc(count, size);
+}
+
+void *realloc(void *ptr, size_t size)
+{
+    allocationCount++;
+    allocatedBytes += size;
+    return __libc_realloc(ptr, size);
+}
+
+void free(void *ptr)
+{
+    __libc_free(ptr);
+}
+#endif
@@ -0,0 +1,164 @@
+// EXPLANATION:
+// Renders a replay (or a demo match) with the software canvas, no window or GPU needed,
+// and prints a hash of every captured frame. Two runs can be diffed to find the first
+// frame that changed, and the frames can be saved as PNGs to see what changed
+// --menu captures the title screen's menus instead, once with each button selected
+//
+// Usage: pong_capture <replay file | --demo seed> [steps between frames] [output directory]
+//        pong_capture --menu [output directory]
+// Frames are only saved when an output directory is given
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "raylib.h"
+#include "platform.h" // for GetWallTime(), raylib's GetTime() needs a window
+#include "config.h" // for RENDER_WIDTH and RENDER_HEIGHT
+#include "pong.h"
+#include "render.h"
+#include "replay.h"
+#include "ui.h"
+
+// Macros
+// --------------------------------------------------------------------------------
+#define DEFAULT_CAPTURE_INTERVAL (SIM_TICK_RATE / 60) // One frame every 60th of a second
+#define DEMO_MAX_TIME 120.0f // Seconds of game time before a demo match is cut off
+
+// Local Functions Declaration
+// --------------------------------------------------------------------------------
+static int CaptureMenus(const char *outputDir);
+static bool SaveCanvasFrame(const Canvas *canvas, const char *fileName);
+
+int main(int argc, char **argv)
+{
+    if (argc < 2 || (strcmp(argv[1], "--demo") == 0 && argc < 3))
+    {
+        fprintf(stderr, "Usage: %s <replay file | --demo seed> [steps between frames] [output directory]\n", argv[0]);
+        fprintf(stderr, "       %s --menu [output directory]\n", argv[0]);
+        return 1;
+    }
+
+    if (strcmp(argv[1], "--menu") == 0)
+    {
+        SetTraceLogLevel(LOG_ERROR);
+        return CaptureMenus((argc > 2) ? argv[2] : NULL);
+    }
+
+    bool isDemo = (strcmp(argv[1], "--demo") == 0);
+    int argStart = isDemo ? 3 : 2;
+    int captureInterval = (argc > argStart) ? atoi(argv[argStart]) : DEFAULT_CAPTURE_INTERVAL;
+    const char *outputDir = (argc > argStart + 1) ? argv[argStart + 1] : NULL;
+    if (captureInterval < 1)
+        captureInterval = 1;
+
+    SetTraceLogLevel(LOG_ERROR); // keep raylib's info logs out of the results
+
+    PongReplay replay = { 0 };
+    GameState pong;
+    if (isDemo)
+    {
+        unsigned int seed = (unsigned int)strtoul(argv[2], NULL, 10);
+        pong = InitGameState(seed, NULL, NULL); // no sound, default config
+        StartPongMatch(&pong, MODE_DEMO, DIFFICULTY_MEDIUM, seed);
+    }
+    else
+    {
+        replay = LoadReplay(argv[1]);
+        if (replay.mode != REPLAY_PLAYING)
+        {
+            fprintf(stderr, "Could not play replay: %s\n", argv[1]);
+            return 1;
+        }
+        pong = InitGameState(replay.seed, NULL, NULL);
+        StartPongMatch(&pong, replay.gameMode, replay.difficulty, replay.seed);
+    }
+
+    Canvas canvas = LoadCanvas(RENDER_WIDTH, RENDER_HEIGHT);
+    SetRenderCanvas(&canvas);
+    Playfield field = { 0 }; // the canvas draws the field lines itself
+
+    printf("# %s, %ix%i, one frame every %i steps\n", argv[isDemo ? 2 : 1], RENDER_WIDTH, RENDER_HEIGHT, captureInterval);
+    printf("# step hash\n");
+
+    PongInput input = { 0 };
+    unsigned int tick = 0;
+    unsigned int frameCount = 0;
+    unsigned int maxDemoTicks = (unsigned int)(DEMO_MAX_TIME * SIM_TICK_RATE);
+    double renderSeconds = 0.0;
+    while (isDemo ? (tick < maxDemoTicks && !pong.playerWon) : PlayReplayTick(&replay, &input))
+    {
+        StepPong(&pong, &input, SIM_TIMESTEP);
+        tick++;
+        if (tick % captureInterval != 0)
+            continue;
+
+        double startTime = GetWallTime();
+        RenderClear(BLACK);
+        DrawPongFrame(&pong, &field);
+        renderSeconds += GetWallTime() - startTime;
+        frameCount++;
+
+        printf("%u %08x\n", tick, GetCanvasHash(&canvas));
+
+        if (outputDir != NULL && !SaveCanvasFrame(&canvas, TextFormat("%s/frame_%06u.png", outputDir, tick)))
+            break;
+    }
+
+    // Timing goes to stderr, so the hashes stay the same between runs
+    fprintf(stderr, "%u frames rendered in %.3f s, %.0f frames/s\n",
+            frameCount, renderSeconds, (renderSeconds > 0) ? frameCount / renderSeconds : 0.0);
+
+    SetRenderCanvas(NULL);
+    UnloadCanvas(&canvas);
+    FreeReplay(&replay);
+
+    return 0;
+}
+
+static int CaptureMenus(const char *outputDir)
+{
+    // The canvas has to be active first, so the buttons are laid out with its text widths
+    Canvas canvas = LoadCanvas(RENDER_WIDTH, RENDER_HEIGHT);
+    SetRenderCanvas(&canvas);
+    UiState ui = InitUiState();
+
+    printf("# menus, %ix%i, one frame per selected button\n", RENDER_WIDTH, RENDER_HEIGHT);
+    printf("# menu button hash\n");
+
+    int result = 0;
+    for (int menu = MENU_TITLE; menu <= MENU_DIFFICULTY && result == 0; menu++)
+    {
+        for (unsigned int button = 0; button < ui.menus[menu].buttonCount; button++)
+        {
+            ui.currentMenu = (UiMenuId)menu;
+            ui.selectedId = button;
+            RenderClear(BLACK);
+            DrawUiFrame(&ui, MENU_TITLE);
+            printf("%i %u %08x\n", menu, button, GetCanvasHash(&canvas));
+
+            if (outputDir != NULL && !SaveCanvasFrame(&canvas, TextFormat("%s/menu%i_button%u.png", outputDir, menu, button)))
+            {
+                result = 1;
+                break;
+            }
+        }
+    }
+
+    SetRenderCanvas(NULL);
+    UnloadCanvas(&canvas);
+
+    return result;
+}
+
+static bool SaveCanvasFrame(const Canvas *canvas, const char *fileName)
+{
+    Image frame = { canvas->pixels, canvas->width, canvas->height, 1, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8 };
+    if (!ExportImage(frame, fileName))
+    {
+        fprintf(stderr, "Could not save %s\n", fileName);
+        return false;
+    }
+
+    return true;
+}
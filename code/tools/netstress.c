@@ -0,0 +1,215 @@
+// EXPLANATION:
+// Plays netplay matches between two peers in one process over localhost, with
+// NetplayConditions standing in for a slow network, and reports how deep the
+// rollbacks go and what they cost. Time is simulated (60 frames a second of 4 steps),
+// so runs are repeatable and take as long as the CPU needs, not the match length
+// Both peers hash every tick once its inputs are confirmed, so any desync is caught
+//
+// Usage: pong_netstress [seconds per run] [base port]
+// Runs every round trip time in the sweep, with and without packet loss
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "raylib.h"
+#include "platform.h" // for GetWallTime(), raylib's GetTime() needs a window
+#include "netplay.h"
+#include "pong.h"
+#include "rng.h"
+#include "snapshot.h"
+
+// Macros
+// --------------------------------------------------------------------------------
+#define STRESS_FPS 60
+#define STRESS_STEPS_PER_FRAME (SIM_TICK_RATE / STRESS_FPS)
+#define DEFAULT_RUN_SECONDS 30
+#define DEFAULT_BASE_PORT 47100
+
+// Types and Structures
+// --------------------------------------------------------------------------------
+typedef struct StressPeer
+{
+    PongNetplay net;
+    GameState pong;
+    PongRng inputRng; // the made up player
+    PongInput input;
+    int inputHoldTicks; // until the made up player changes their move
+    unsigned int *hashes; // per tick, once confirmed
+    unsigned int hashedTicks;
+} StressPeer;
+
+// Local Variables Definition
+// --------------------------------------------------------------------------------
+static const int roundTripTimes[] = { 0, 50, 100, 150, 200 }; // ms
+static const int lossRates[] = { 0, 5 }; // %
+
+// Local Functions Declaration
+// --------------------------------------------------------------------------------
+static void RunStress(int roundTrip, int loss, int seconds, unsigned short basePort, unsigned int seed);
+static void UpdateStressInput(StressPeer *peer); // Holds a random move for a while, now and then skipping the win screen
+static void HashConfirmedTicks(StressPeer *peer, unsigned int maxTicks);
+static unsigned int HashPongSnapshot(const PongSnapshot *snapshot);
+
+int main(int argc, char **argv)
+{
+    int seconds = (argc > 1) ? atoi(argv[1]) : DEFAULT_RUN_SECONDS;
+    unsigned short basePort = (unsigned short)((argc > 2) ? atoi(argv[2]) : DEFAULT_BASE_PORT);
+    if (seconds < 1)
+        seconds = 1;
+
+    SetTraceLogLevel(LOG_WARNING); // keep the netplay info logs out of the results
+
+    printf("# %i s per run, %i frames/s of %i steps\n", seconds, STRESS_FPS, STRESS_STEPS_PER_FRAME);
+    printf("# rtt_ms loss%% rollbacks avg_depth max_depth resim/frame us/frame stalls sent dropped desync\n");
+
+    unsigned int seed = 1;
+    for (int i = 0; i < (int)(sizeof(roundTripTimes) / sizeof(roundTripTimes[0])); i++)
+    {
+        for (int j = 0; j < (int)(sizeof(lossRates) / sizeof(lossRates[0])); j++)
+            RunStress(roundTripTimes[i], lossRates[j], seconds, basePort, seed++);
+    }
+
+    return 0;
+}
+
+static void RunStress(int roundTrip, int loss, int seconds, unsigned short basePort, unsigned int seed)
+{
+    unsigned int frameCount = (unsigned int)(seconds * STRESS_FPS);
+    unsigned int maxTicks = frameCount * STRESS_STEPS_PER_FRAME;
+
+    StressPeer peers[2] = { 0 };
+    for (int i = 0; i < 2; i++)
+    {
+        StressPeer *peer = &peers[i];
+        peer->net = InitNetplay((NetplaySide)i, basePort + i, "127.0.0.1", basePort + 1 - i, seed);
+        if (peer->net.mode == NETPLAY_OFF)
+        {
+            fprintf(stderr, "Could not start netplay on port %i\n", basePort + i);
+            CloseNetplay(&peers[0].net);
+            return;
+        }
+        peer->net.conditions.latency = roundTrip / 2000.0f;
+        peer->net.conditions.jitter = peer->net.conditions.latency * 0.1f;
+        peer->net.conditions.loss = loss / 100.0f;
+
+        peer->pong = InitGameState(seed, NULL, NULL);
+        peer->inputRng = InitPongRng(seed, 100 + i);
+        peer->hashes = MemAlloc(maxTicks * sizeof(unsigned int));
+    }
+
+    double netSeconds = 0.0;
+    for (unsigned int frame = 0; frame < frameCount; frame++)
+    {
+        double time = (double)frame / STRESS_FPS;
+        for (int i = 0; i < 2; i++)
+        {
+            StressPeer *peer = &peers[i];
+            double startTime = GetWallTime();
+            PollNetplay(&peer->net, &peer->pong, time);
+            for (int step = 0; step < STRESS_STEPS_PER_FRAME; step++)
+            {
+                UpdateStressInput(peer);
+                if (StepNetplay(&peer->net, &peer->pong, &peer->input))
+                    ClearPongInputPresses(&peer->input);
+            }
+            SendNetplayInputs(&peer->net, time);
+            netSeconds += GetWallTime() - startTime;
+
+            HashConfirmedTicks(peer, maxTicks);
+        }
+    }
+
+    // Every tick both peers confirmed should have played out the same
+    unsigned int checkedTicks = (peers[0].hashedTicks < peers[1].hashedTicks) ? peers[0].hashedTicks : peers[1].hashedTicks;
+    int desyncTick = -1;
+    for (unsigned int tick = 0; tick < checkedTicks; tick++)
+    {
+        if (peers[0].hashes[tick] != peers[1].hashes[tick])
+        {
+            desyncTick = (int)tick;
+            break;
+        }
+    }
+
+    // Both peers together
+    NetplayStats total = { 0 };
+    for (int i = 0; i < 2; i++)
+    {
+        const NetplayStats *stats = &peers[i].net.stats;
+        total.rollbacks += stats->rollbacks;
+        total.resimulatedTicks += stats->resimulatedTicks;
+        if (stats->maxRollback > total.maxRollback)
+            total.maxRollback = stats->maxRollback;
+        total.stalledTicks += stats->stalledTicks;
+        total.packetsSent += stats->packetsSent;
+        total.packetsDropped += stats->packetsDropped;
+    }
+    unsigned int peerFrames = frameCount * 2;
+
+    printf("%6i %5i %9u %9.2f %9u %11.2f %8.2f %6u %6u %7u ",
+           roundTrip, loss, total.rollbacks,
+           (total.rollbacks > 0) ? (double)total.resimulatedTicks / total.rollbacks : 0.0, total.maxRollback,
+           (double)total.resimulatedTicks / peerFrames, netSeconds * 1e6 / peerFrames,
+           total.stalledTicks, total.packetsSent, total.packetsDropped);
+    if (checkedTicks == 0)
+        printf("unchecked\n");
+    else if (desyncTick >= 0)
+        printf("tick %i\n", desyncTick);
+    else
+        printf("none (%u ticks)\n", checkedTicks);
+
+    for (int i = 0; i < 2; i++)
+    {
+        CloseNetplay(&peers[i].net);
+        MemFree(peers[i].hashes);
+    }
+}
+
+static void UpdateStressInput(StressPeer *peer)
+{
+    if (--peer->inputHoldTicks <= 0)
+    {
+        // Half the moves are the same as the last, so most guesses come out right
+        peer->inputHoldTicks = GetPongRngValue(&peer->inputRng, 10, 60);
+        if (GetPongRngValue(&peer->inputRng, 0, 1) == 0)
+            peer->input.moveL = (float)GetPongRngValue(&peer->inputRng, -2, 2);
+    }
+
+    // The win screen waits for a press or runs out after a while anyway
+    if (peer->pong.playerWon && GetPongRngValue(&peer->inputRng, 0, SIM_TICK_RATE) == 0)
+        peer->input.skipPressed = true;
+}
+
+static void HashConfirmedTicks(StressPeer *peer, unsigned int maxTicks)
+{
+    // Snapshots are the game before each tick, so the one at remoteTick is the
+    // last with every input known. Past a rollback they never change again
+    const PongNetplay *net = &peer->net;
+    if (net->mode != NETPLAY_PLAYING)
+        return;
+
+    while (peer->hashedTicks <= net->remoteTick && peer->hashedTicks <= net->tick && peer->hashedTicks < maxTicks)
+    {
+        unsigned int tick = peer->hashedTicks;
+        PongSnapshot snapshot = (tick == net->tick) ? TakePongSnapshot(&peer->pong) : net->snapshots[tick % NETPLAY_RING_SIZE];
+        peer->hashes[tick] = HashPongSnapshot(&snapshot);
+        peer->hashedTicks++;
+    }
+}
+
+static unsigned int HashPongSnapshot(const PongSnapshot *snapshot)
+{
+    // FNV-1a over the saved bytes, so it's the same on any machine
+    unsigned char data[PONG_SNAPSHOT_SIZE];
+    WritePongSnapshot(snapshot, data);
+
+    unsigned int hash = 2166136261u;
+    for (int i = 0; i < PONG_SNAPSHOT_SIZE; i++)
+    {
+        hash ^= data[i];
+        hash *= 16777619u;
+    }
+
+    return hash;
+}
@@ -0,0 +1,79 @@
+// EXPLANATION:
+// Plays a replay recorded with "pong --record <file>" as fast as possible, with
+// no window, and prints the game state as it goes. Two traces can be diffed to
+// find the exact step where a change made the game play differently
+//
+// Usage: pong_replay <replay file> [steps between trace lines]
+// Pass 0 steps to only print the final state
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "raylib.h"
+#include "platform.h" // for GetWallTime(), raylib's GetTime() needs a window
+#include "pong.h"
+#include "replay.h"
+
+// Local Functions Declaration
+// --------------------------------------------------------------------------------
+static void PrintTraceLine(unsigned int tick, const GameState *pong);
+
+int main(int argc, char **argv)
+{
+    if (argc < 2)
+    {
+        fprintf(stderr, "Usage: %s <replay file> [steps between trace lines]\n", argv[0]);
+        return 1;
+    }
+    int traceInterval = (argc > 2) ? atoi(argv[2]) : 1;
+
+    SetTraceLogLevel(LOG_ERROR); // keep raylib's info logs out of the results
+
+    PongReplay replay = LoadReplay(argv[1]);
+    if (replay.mode != REPLAY_PLAYING)
+    {
+        fprintf(stderr, "Could not play replay: %s\n", argv[1]);
+        return 1;
+    }
+
+    GameState pong = InitGameState(replay.seed, NULL, NULL); // no sound, default config
+    StartPongMatch(&pong, replay.gameMode, replay.difficulty, replay.seed);
+
+    // Floats are printed with enough digits to tell any two values apart
+    printf("# seed %u, mode %i, difficulty %i, %i steps per second\n",
+           replay.seed, replay.gameMode, replay.difficulty, SIM_TICK_RATE);
+    printf("# step ballX ballY ballDirX ballDirY ballSpeed paddleLY paddleRY scoreL scoreR\n");
+
+    double startTime = GetWallTime();
+    PongInput input = { 0 };
+    unsigned int tick = 0;
+    while (PlayReplayTick(&replay, &input))
+    {
+        StepPong(&pong, &input, SIM_TIMESTEP);
+        tick++;
+
+        if (traceInterval > 0 && tick % traceInterval == 0)
+            PrintTraceLine(tick, &pong);
+    }
+    double seconds = GetWallTime() - startTime;
+
+    if (traceInterval <= 0 || tick % traceInterval != 0)
+        PrintTraceLine(tick, &pong);
+
+    // Timing goes to stderr, so traces stay the same between runs
+    fprintf(stderr, "%u steps (%.1f s of game time) in %.3f s, %.0f steps/s\n",
+            tick, (float)tick / SIM_TICK_RATE, seconds, (seconds > 0) ? tick / seconds : 0.0);
+
+    FreeReplay(&replay);
+
+    return 0;
+}
+
+static void PrintTraceLine(unsigned int tick, const GameState *pong)
+{
+    printf("%u %.9g %.9g %.9g %.9g %.9g %.9g %.9g %i %i\n", tick,
+           pong->ball.position.x, pong->ball.position.y,
+           pong->ball.direction.x, pong->ball.direction.y, pong->ball.speed,
+           pong->paddleL.position.y, pong->paddleR.position.y,
+           pong->scoreL, pong->scoreR);
+}
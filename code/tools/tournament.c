@@ -0,0 +1,358 @@
+// EXPLANATION:
+// Headless round-robin tournament between computer paddle configurations
+// Every pairing plays a number of MODE_DEMO matches with StepPong(), spread over
+// all CPU cores with a work-stealing job queue, then win rates and a histogram
+// of rally lengths are printed
+//
+// Usage: pong_tournament [--config file] [matches per pairing] [thread count] [seed]
+// The same seed and match count always give the same results, on any thread count
+// A config file changes the rules for every match, see LoadPongConfig() in pong.h
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "raylib.h"
+#include "platform.h" // for threads, locks and GetWallTime()
+#include "pong.h"
+
+// Macros
+// --------------------------------------------------------------------------------
+#define DEFAULT_MATCHES_PER_PAIRING 200
+#define MAX_THREADS 256
+#define MAX_MATCH_TIME (60.0f * 30)  // Matches longer than this are called a draw
+#define RALLY_HISTOGRAM_SIZE 32      // Last bucket holds every longer rally
+#define HISTOGRAM_BAR_WIDTH 50
+
+// Types and Structures
+// --------------------------------------------------------------------------------
+typedef struct Contestant
+{
+    const char *name;
+    ComputerAi ai; // speed is times the match's paddleSpeed here, see PlayMatch()
+} Contestant;
+
+typedef struct MatchJob
+{
+    int contestantL;
+    int contestantR;
+} MatchJob;
+
+typedef struct JobDeque // The owner takes jobs from the bottom, thieves from the top
+{
+    PlatformMutex lock;
+    int *jobs;
+    int top;
+    int bottom;
+} JobDeque;
+
+typedef struct WorkerResults // Each worker counts alone, results are merged at the end
+{
+    int *wins; // [winner * contestantCount + loser]
+    int *draws; // [contestant]
+    unsigned long long rallies[RALLY_HISTOGRAM_SIZE];
+    int matchesPlayed;
+    int jobsStolen;
+} WorkerResults;
+
+typedef struct Tournament
+{
+    const Contestant *contestants;
+    int contestantCount;
+    MatchJob *jobs;
+    int jobCount;
+    JobDeque *deques;
+    WorkerResults *results;
+    int workerCount;
+    unsigned int seed; // Match i is seeded with seed + i
+    const PongConfig *config; // Rules for every match
+} Tournament;
+
+typedef struct WorkerArgs
+{
+    Tournament *tournament;
+    int workerId;
+} WorkerArgs;
+
+// Local Variables Definition
+// --------------------------------------------------------------------------------
+static const Contestant contestants[] = { // reaction delay, aim error, speed (times paddleSpeed), slowdown after hit, hit strategy
+    { "easy",          { 0.35f, 65.0f, 2.0f, 3.0f, HIT_RANDOM } },
+    { "medium",        { 0.20f, 35.0f, 2.0f, 3.0f, HIT_RANDOM } },
+    { "hard",          { 0.08f, 15.0f, 2.0f, 3.0f, HIT_RANDOM } },
+    { "medium-center", { 0.20f, 35.0f, 2.0f, 3.0f, HIT_CENTER } },
+    { "medium-edge",   { 0.20f, 35.0f, 2.0f, 3.0f, HIT_EDGE   } },
+    { "hard-slow",     { 0.08f, 15.0f, 1.5f, 3.0f, HIT_RANDOM } },
+    { "perfect",       { 0.00f,  0.0f, 2.0f, 1.0f, HIT_EDGE   } },
+};
+
+// Local Functions Declaration
+// --------------------------------------------------------------------------------
+static bool TakeJob(Tournament *tournament, int workerId, int *job); // Pops own work first, then steals
+static void PlayMatch(const Tournament *tournament, const MatchJob *job, WorkerResults *results);
+static void RunWorker(void *args);
+static void PrintResults(const Tournament *tournament, double seconds);
+
+int main(int argc, char **argv)
+{
+    // --config can go anywhere, everything else is positional
+    const char *configFile = NULL;
+    const char *positional[3] = { 0 };
+    int argCount = 0;
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--config") == 0 && i + 1 < argc)
+            configFile = argv[++i];
+        else if (argCount < 3)
+            positional[argCount++] = argv[i];
+    }
+
+    int matchesPerPairing = (argCount > 0) ? atoi(positional[0]) : DEFAULT_MATCHES_PER_PAIRING;
+    int workerCount = (argCount > 1) ? atoi(positional[1]) : GetCpuCount();
+    unsigned int seed = (argCount > 2) ? (unsigned int)strtoul(positional[2], NULL, 10) : 1;
+    if (matchesPerPairing < 1)
+        matchesPerPairing = 1;
+    if (workerCount < 1)
+        workerCount = 1;
+    if (workerCount > MAX_THREADS)
+        workerCount = MAX_THREADS;
+
+    SetTraceLogLevel(LOG_WARNING); // keep raylib's info logs out of the results, but show config mistakes
+    PongConfig config = defaultPongConfig;
+    if (configFile != NULL && !LoadPongConfig(&config, configFile))
+    {
+        fprintf(stderr, "Could not read config: %s\n", configFile);
+        return 1;
+    }
+
+    // Every pairing plays on both sides of the field equally
+    Tournament tournament = { 0 };
+    tournament.contestants = contestants;
+    tournament.contestantCount = (int)(sizeof(contestants) / sizeof(contestants[0]));
+    tournament.workerCount = workerCount;
+    tournament.seed = seed;
+    tournament.config = &config;
+    int pairings = tournament.contestantCount * (tournament.contestantCount - 1) / 2;
+    tournament.jobCount = pairings * matchesPerPairing;
+    tournament.jobs = MemAlloc(tournament.jobCount * sizeof(MatchJob));
+
+    int jobIndex = 0;
+    for (int a = 0; a < tournament.contestantCount; a++)
+    {
+        for (int b = a + 1; b < tournament.contestantCount; b++)
+        {
+            for (int m = 0; m < matchesPerPairing; m++)
+            {
+                bool swapSides = (m % 2 == 1);
+                tournament.jobs[jobIndex].contestantL = swapSides ? b : a;
+                tournament.jobs[jobIndex].contestantR = swapSides ? a : b;
+                jobIndex++;
+            }
+        }
+    }
+
+    // Deal the jobs out in order, so early workers start with similar pairings
+    // and stealing evens out the matches that run long
+    tournament.deques = MemAlloc(workerCount * sizeof(JobDeque));
+    tournament.results = MemAlloc(workerCount * sizeof(WorkerResults));
+    for (int w = 0; w < workerCount; w++)
+    {
+        JobDeque *deque = &tournament.deques[w];
+        deque->lock = InitPlatformMutex();
+        deque->jobs = MemAlloc((tournament.jobCount / workerCount + 1) * sizeof(int));
+        tournament.results[w].wins = MemAlloc(tournament.contestantCount * tournament.contestantCount * sizeof(int));
+        tournament.results[w].draws = MemAlloc(tournament.contestantCount * sizeof(int));
+    }
+    for (int j = 0; j < tournament.jobCount; j++)
+    {
+        JobDeque *deque = &tournament.deques[(long long)j * workerCount / tournament.jobCount]; // int would overflow on huge runs
+        deque->jobs[deque->bottom++] = j;
+    }
+
+    printf("Tournament: %i contestants, %i matches, %i threads, seed %u, config %s\n",
+           tournament.contestantCount, tournament.jobCount, workerCount, seed,
+           (configFile != NULL) ? configFile : "default");
+
+    double startTime = GetWallTime();
+    PlatformThread threads[MAX_THREADS];
+    WorkerArgs args[MAX_THREADS];
+    for (int w = 0; w < workerCount; w++)
+    {
+        args[w] = (WorkerArgs){ &tournament, w };
+        StartPlatformThread(&threads[w], RunWorker, &args[w]);
+    }
+    for (int w = 0; w < workerCount; w++)
+        JoinPlatformThread(&threads[w]);
+
+    PrintResults(&tournament, GetWallTime() - startTime);
+
+    for (int w = 0; w < workerCount; w++)
+    {
+        FreePlatformMutex(&tournament.deques[w].lock);
+        MemFree(tournament.deques[w].jobs);
+        MemFree(tournament.results[w].wins);
+        MemFree(tournament.results[w].draws);
+    }
+    MemFree(tournament.deques);
+    MemFree(tournament.results);
+    MemFree(tournament.jobs);
+
+    return 0;
+}
+
+static bool TakeJob(Tournament *tournament, int workerId, int *job)
+{
+    // Own deque first, newest job first
+    JobDeque *own = &tournament->deques[workerId];
+    LockPlatformMutex(&own->lock);
+    bool found = (own->bottom > own->top);
+    if (found)
+        *job = own->jobs[--own->bottom];
+    UnlockPlatformMutex(&own->lock);
+    if (found)
+        return true;
+
+    // Then steal the oldest job from the others, starting with the next worker
+    for (int i = 1; i < tournament->workerCount; i++)
+    {
+        JobDeque *victim = &tournament->deques[(workerId + i) % tournament->workerCount];
+        LockPlatformMutex(&victim->lock);
+        found = (victim->bottom > victim->top);
+        if (found)
+            *job = victim->jobs[victim->top++];
+        UnlockPlatformMutex(&victim->lock);
+        if (found)
+        {
+            tournament->results[workerId].jobsStolen++;
+            return true;
+        }
+    }
+
+    // Jobs are never added after the start, so every deque is empty for good
+    return false;
+}
+
+static void PlayMatch(const Tournament *tournament, const MatchJob *job, WorkerResults *results)
+{
+    // Seeded by the job, so results don't depend on which thread plays it
+    GameState pong = InitGameState(tournament->seed + (unsigned int)(job - tournament->jobs), NULL, tournament->config);
+    pong.currentScreen = SCREEN_GAMEPLAY;
+    pong.currentMode = MODE_DEMO;
+    pong.paddleL.ai = tournament->contestants[job->contestantL].ai;
+    pong.paddleR.ai = tournament->contestants[job->contestantR].ai;
+    pong.paddleL.ai.speed *= PONG_CONFIG(pong.config)->paddleSpeed; // same as the players, so config files speed up everyone
+    pong.paddleR.ai.speed *= PONG_CONFIG(pong.config)->paddleSpeed;
+
+    PongInput input = { 0 };
+    int pointsPlayed = 0;
+    int hitsAtServe = 0;
+    int maxSteps = (int)(MAX_MATCH_TIME * SIM_TICK_RATE);
+    for (int step = 0; step < maxSteps && !pong.playerWon; step++)
+    {
+        StepPong(&pong, &input, SIM_TIMESTEP);
+
+        // Record the rally length every time a point is scored
+        if (pong.scoreL + pong.scoreR != pointsPlayed)
+        {
+            int rally = pong.ball.paddleHits - hitsAtServe;
+            results->rallies[(rally < RALLY_HISTOGRAM_SIZE) ? rally : RALLY_HISTOGRAM_SIZE - 1]++;
+            pointsPlayed = pong.scoreL + pong.scoreR;
+            hitsAtServe = pong.ball.paddleHits;
+        }
+    }
+
+    int count = tournament->contestantCount;
+    if (pong.scoreL >= tournament->config->winScore)
+        results->wins[job->contestantL * count + job->contestantR]++;
+    else if (pong.scoreR >= tournament->config->winScore)
+        results->wins[job->contestantR * count + job->contestantL]++;
+    else
+    {
+        results->draws[job->contestantL]++;
+        results->draws[job->contestantR]++;
+    }
+    results->matchesPlayed++;
+}
+
+static void RunWorker(void *args)
+{
+    WorkerArgs *worker = args;
+    Tournament *tournament = worker->tournament;
+    int job;
+    while (TakeJob(tournament, worker->workerId, &job))
+        PlayMatch(tournament, &tournament->jobs[job], &tournament->results[worker->workerId]);
+}
+
+static void PrintResults(const Tournament *tournament, double seconds)
+{
+    int count = tournament->contestantCount;
+    int *wins = MemAlloc(count * count * sizeof(int));
+    int *draws = MemAlloc(count * sizeof(int));
+    unsigned long long rallies[RALLY_HISTOGRAM_SIZE] = { 0 };
+    unsigned long long totalRallies = 0;
+    int jobsStolen = 0;
+
+    // Merge the results of every worker
+    for (int w = 0; w < tournament->workerCount; w++)
+    {
+        const WorkerResults *results = &tournament->results[w];
+        for (int i = 0; i < count * count; i++)
+            wins[i] += results->wins[i];
+        for (int i = 0; i < count; i++)
+            draws[i] += results->draws[i];
+        for (int i = 0; i < RALLY_HISTOGRAM_SIZE; i++)
+        {
+            rallies[i] += results->rallies[i];
+            totalRallies += results->rallies[i];
+        }
+        jobsStolen += results->jobsStolen;
+        printf("  thread %3i: %6i matches, %6i stolen\n", w, results->matchesPlayed, results->jobsStolen);
+    }
+
+    printf("\n%i matches in %.2f s (%.1f matches/s), %i jobs stolen\n\n",
+           tournament->jobCount, seconds, tournament->jobCount / seconds, jobsStolen);
+
+    // Win rate of each row against each column
+    printf("%-16s", "win rate");
+    for (int b = 0; b < count; b++)
+        printf(" %8.8s", tournament->contestants[b].name);
+    printf(" %8s %6s\n", "overall", "draws");
+    for (int a = 0; a < count; a++)
+    {
+        int totalWins = 0, totalGames = draws[a];
+        printf("%-16s", tournament->contestants[a].name);
+        for (int b = 0; b < count; b++)
+        {
+            int played = wins[a * count + b] + wins[b * count + a];
+            totalWins += wins[a * count + b];
+            totalGames += played;
+            if (a == b || played == 0)
+                printf(" %8s", "-");
+            else
+                printf(" %7.1f%%", 100.0f * wins[a * count + b] / played);
+        }
+        printf(" %7.1f%% %6i\n", (totalGames > 0) ? 100.0f * totalWins / totalGames : 0.0f, draws[a]);
+    }
+
+    // Rally length histogram, in paddle hits per point
+    unsigned long long mostRallies = 1;
+    for (int i = 0; i < RALLY_HISTOGRAM_SIZE; i++)
+        if (rallies[i] > mostRallies)
+            mostRallies = rallies[i];
+
+    printf("\nRally length (paddle hits per point), %llu points\n", totalRallies);
+    for (int i = 0; i < RALLY_HISTOGRAM_SIZE; i++)
+    {
+        if (rallies[i] == 0)
+            continue;
+        char bar[HISTOGRAM_BAR_WIDTH + 1];
+        int barLength = (int)(rallies[i] * HISTOGRAM_BAR_WIDTH / mostRallies);
+        memset(bar, '#', barLength);
+        bar[barLength] = '\0';
+        printf("%3i%s %10llu %6.2f%% %s\n", i, (i == RALLY_HISTOGRAM_SIZE - 1) ? "+" : " ",
+               rallies[i], 100.0 * rallies[i] / totalRallies, bar);
+    }
+
+    MemFree(wins);
+    MemFree(draws);
+}
@@ -0,0 +1,275 @@
+// EXPLANATION:
+// Correctness checks for the game logic, with no window
+// Each check prints what it compared and passes or fails, and the program exits
+// with 1 if any of them failed
+//
+// Usage: pong_verify [name filter]
+
+#include <math.h> // for sinf()
+#include <stdio.h>
+#include <string.h>
+#if defined(__GLIBC__)
+    #include <malloc.h> // for mallinfo2(), to see how much of the heap is in use
+#endif
+
+#include "raylib.h"
+#include "batch.h"
+#include "pong.h"
+#include "ui.h"
+
+// Macros
+// --------------------------------------------------------------------------------
+#define VERIFY_BATCH_COUNT 1027 // Not a multiple of 8, so the SIMD kernels' leftover lanes are checked too
+#define VERIFY_BATCH_STEPS (SIM_TICK_RATE * 120) // Long enough for plenty of scores and finished matches
+#define VERIFY_BATCH_SEED 1
+#define VERIFY_GAME_COUNT 64 // Batch matches replayed with StepPong(), one seed each
+#define VERIFY_RESETS 10000 // Of each kind, for the memory soak
+
+// Heap use can only be measured with glibc 2.33 or newer
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || __GLIBC_MINOR__ >= 33)
+    #define VERIFY_HEAP_IN_USE
+#endif
+
+// Types and Structures
+// --------------------------------------------------------------------------------
+typedef struct VerifyCheck
+{
+    const char *name;
+    bool (*run)(void);
+} VerifyCheck;
+
+// Local Functions Declaration
+// --------------------------------------------------------------------------------
+static bool CheckPongBatchKernels(void); // Every supported kernel steps matches bit for bit like the scalar one
+static PongBatch RunPongBatch(BatchKernel kernel);
+static bool ComparePongBatches(const PongBatch *a, const PongBatch *b);
+static bool CheckPongBatchGames(void); // Every batch match plays exactly like a StepPong() demo game, with any rules
+static bool RunPongBatchGames(const PongConfig *config, const char *rulesName);
+static bool ComparePongBatchGame(const PongBatch *batch, int index, const GameState *pong);
+static bool CheckResetMemory(void); // Returning to the title and starting the next match leave nothing allocated
+
+// Local Variables Definition
+// --------------------------------------------------------------------------------
+static const VerifyCheck checks[] = {
+    { "StepPongBatch/kernels", CheckPongBatchKernels },
+    { "StepPongBatch/StepPong", CheckPongBatchGames },
+    { "ReturnToTitle/soak",    CheckResetMemory },
+};
+
+int main(int argc, char **argv)
+{
+    const char *filter = (argc > 1) ? argv[1] : NULL;
+
+    SetTraceLogLevel(LOG_ERROR); // keep raylib's info logs out of the results
+
+    int failures = 0;
+    for (int i = 0; i < (int)(sizeof(checks) / sizeof(checks[0])); i++)
+    {
+        if (filter != NULL && strstr(checks[i].name, filter) == NULL)
+            continue;
+        bool passed = checks[i].run();
+        printf("%-30s %s\n", checks[i].name, passed ? "ok" : "FAILED");
+        failures += !passed;
+    }
+
+    return (failures == 0) ? 0 : 1;
+}
+
+static bool CheckPongBatchKernels(void)
+{
+    PongBatch reference = RunPongBatch(BATCH_KERNEL_SCALAR);
+
+    bool passed = true;
+    for (BatchKernel kernel = BATCH_KERNEL_SSE2; kernel <= BATCH_KERNEL_AVX2; kernel++)
+    {
+        if (!IsPongBatchKernelSupported(kernel))
+        {
+            printf("  %s: not supported here, skipped\n", GetPongBatchKernelName(kernel));
+            continue;
+        }
+
+        PongBatch batch = RunPongBatch(kernel);
+        bool matches = ComparePongBatches(&reference, &batch);
+        printf("  %s: %s\n", GetPongBatchKernelName(kernel), matches ? "matches scalar" : "differs from scalar");
+        passed &= matches;
+        FreePongBatch(&batch);
+    }
+
+    FreePongBatch(&reference);
+    return passed;
+}
+
+static PongBatch RunPongBatch(BatchKernel kernel)
+{
+    PongBatch batch = InitPongBatch(VERIFY_BATCH_COUNT, VERIFY_BATCH_SEED, NULL);
+    batch.kernel = kernel;
+    SetPongBatchDifficulty(&batch, DIFFICULTY_HARD);
+    for (int step = 0; step < VERIFY_BATCH_STEPS; step++)
+        StepPongBatch(&batch, SIM_TIMESTEP);
+    return batch;
+}
+
+static bool ComparePongBatches(const PongBatch *a, const PongBatch *b)
+{
+    // Only the live matches, the padding past count is scratch space
+    size_t floats = a->count * sizeof(float);
+    size_t ints = a->count * sizeof(int);
+    size_t uints = a->count * sizeof(unsigned int);
+    return a->count == b->count &&
+           memcmp(a->ballX, b->ballX, floats) == 0 &&
+           memcmp(a->ballY, b->ballY, floats) == 0 &&
+           memcmp(a->ballDirX, b->ballDirX, floats) == 0 &&
+           memcmp(a->ballDirY, b->ballDirY, floats) == 0 &&
+           memcmp(a->ballSpeed, b->ballSpeed, floats) == 0 &&
+           memcmp(a->paddleHits, b->paddleHits, ints) == 0 &&
+           memcmp(a->trajectoryId, b->trajectoryId, uints) == 0 &&
+           memcmp(a->paddleLY, b->paddleLY, floats) == 0 &&
+           memcmp(a->paddleRY, b->paddleRY, floats) == 0 &&
+           memcmp(a->paddleLSpeed, b->paddleLSpeed, floats) == 0 &&
+           memcmp(a->paddleRSpeed, b->paddleRSpeed, floats) == 0 &&
+           memcmp(a->nextHitPosL, b->nextHitPosL, floats) == 0 &&
+           memcmp(a->nextHitPosR, b->nextHitPosR, floats) == 0 &&
+           memcmp(a->predictionIdL, b->predictionIdL, uints) == 0 &&
+           memcmp(a->predictionIdR, b->predictionIdR, uints) == 0 &&
+           memcmp(a->targetYL, b->targetYL, floats) == 0 &&
+           memcmp(a->targetYR, b->targetYR, floats) == 0 &&
+           memcmp(a->nextTargetYL, b->nextTargetYL, floats) == 0 &&
+           memcmp(a->nextTargetYR, b->nextTargetYR, floats) == 0 &&
+           memcmp(a->reactionTimerL, b->reactionTimerL, floats) == 0 &&
+           memcmp(a->reactionTimerR, b->reactionTimerR, floats) == 0 &&
+           memcmp(a->scoreTimer, b->scoreTimer, floats) == 0 &&
+           memcmp(a->scoreL, b->scoreL, ints) == 0 &&
+           memcmp(a->scoreR, b->scoreR, ints) == 0 &&
+           memcmp(a->winsL, b->winsL, uints) == 0 &&
+           memcmp(a->winsR, b->winsR, uints) == 0 &&
+           memcmp(a->rng, b->rng, a->count * sizeof(PongRng)) == 0;
+}
+
+static bool CheckPongBatchGames(void)
+{
+    // Different sizes and speeds everywhere, so nothing can lean on the defaults
+    PongConfig config = defaultPongConfig;
+    config.winScore = 3;
+    config.paddleLength = 120;
+    config.paddleWidth = 30;
+    config.paddleSpeed = 300.0f;
+    config.ballSize = 14;
+    config.ballSpeed = 420.0f;
+    config.minimumVerticalAngle = 35.0f;
+    config.minimumVerticalSin = sinf(config.minimumVerticalAngle * (PI / 180.0f));
+    config.scorePauseTime = 0.5f;
+
+    bool passed = RunPongBatchGames(NULL, "default rules");
+    passed &= RunPongBatchGames(&config, "custom rules");
+    return passed;
+}
+
+static bool RunPongBatchGames(const PongConfig *config, const char *rulesName)
+{
+    // Easy computers miss often enough for plenty of finished matches
+    PongBatch batch = InitPongBatch(VERIFY_GAME_COUNT, VERIFY_BATCH_SEED, config);
+    SetPongBatchDifficulty(&batch, DIFFICULTY_EASY);
+
+    // Match i started from seed + i, skipping every win screen like the batch does
+    GameState *games = MemAlloc(VERIFY_GAME_COUNT * sizeof(GameState));
+    int *finished = MemAlloc(VERIFY_GAME_COUNT * sizeof(int));
+    for (int i = 0; i < VERIFY_GAME_COUNT; i++)
+    {
+        games[i] = InitGameState(VERIFY_BATCH_SEED + (unsigned int)i, NULL, config);
+        games[i].currentScreen = SCREEN_GAMEPLAY;
+        games[i].currentMode = MODE_DEMO;
+        SetGameDifficulty(&games[i], DIFFICULTY_EASY);
+    }
+
+    PongInput skip = { .skipPressed = true };
+    for (int step = 0; step < VERIFY_BATCH_STEPS; step++)
+    {
+        StepPongBatch(&batch, SIM_TIMESTEP);
+        for (int i = 0; i < VERIFY_GAME_COUNT; i++)
+        {
+            int prevScore = games[i].scoreL + games[i].scoreR;
+            StepPong(&games[i], &skip, SIM_TIMESTEP);
+            finished[i] += (games[i].scoreL + games[i].scoreR < prevScore); // A new match started
+        }
+    }
+
+    int differences = 0;
+    int totalFinished = 0;
+    for (int i = 0; i < VERIFY_GAME_COUNT; i++)
+    {
+        bool matches = ComparePongBatchGame(&batch, i, &games[i]) &&
+                       (int)(batch.winsL[i] + batch.winsR[i]) == finished[i];
+        differences += !matches;
+        totalFinished += finished[i];
+    }
+    printf("  %i games (%i finished matches) with %s on %s: %i differ\n",
+           VERIFY_GAME_COUNT, totalFinished, rulesName, GetPongBatchKernelName(batch.kernel), differences);
+
+    MemFree(finished);
+    MemFree(games);
+    FreePongBatch(&batch);
+    return (differences == 0);
+}
+
+static bool ComparePongBatchGame(const PongBatch *batch, int index, const GameState *pong)
+{
+    // Paddle speeds are left out, the batch starts them at 0 instead of the config's speed
+    int i = index;
+    return batch->ballX[i] == pong->ball.position.x && batch->ballY[i] == pong->ball.position.y &&
+           batch->ballDirX[i] == pong->ball.direction.x && batch->ballDirY[i] == pong->ball.direction.y &&
+           batch->ballSpeed[i] == pong->ball.speed &&
+           batch->paddleHits[i] == pong->ball.paddleHits &&
+           batch->trajectoryId[i] == pong->ball.trajectoryId &&
+           batch->paddleLY[i] == pong->paddleL.position.y && batch->paddleRY[i] == pong->paddleR.position.y &&
+           batch->nextHitPosL[i] == pong->paddleL.nextHitPos && batch->nextHitPosR[i] == pong->paddleR.nextHitPos &&
+           batch->predictionIdL[i] == pong->paddleL.predictionId && batch->predictionIdR[i] == pong->paddleR.predictionId &&
+           batch->targetYL[i] == pong->paddleL.targetY && batch->targetYR[i] == pong->paddleR.targetY &&
+           batch->nextTargetYL[i] == pong->paddleL.nextTargetY && batch->nextTargetYR[i] == pong->paddleR.nextTargetY &&
+           batch->reactionTimerL[i] == pong->paddleL.reactionTimer && batch->reactionTimerR[i] == pong->paddleR.reactionTimer &&
+           batch->scoreTimer[i] == pong->scoreTimer &&
+           batch->scoreL[i] == pong->scoreL && batch->scoreR[i] == pong->scoreR &&
+           memcmp(&batch->rng[i], &pong->rng, sizeof(PongRng)) == 0;
+}
+
+static bool CheckResetMemory(void)
+{
+#if defined(VERIFY_HEAP_IN_USE)
+    GameState pong = InitGameState(1, NULL, NULL);
+    UiState ui = InitUiState();
+    PongInput input = { 0 };
+    PongInput skip = { .skipPressed = true };
+    int winScore = PONG_CONFIG(pong.config)->winScore;
+
+    // Once first, so anything made the first time (like cached text) isn't counted
+    bool passed = true;
+    for (int round = 0; round < 2; round++)
+    {
+        size_t startInUse = mallinfo2().uordblks;
+        int resets = (round == 0) ? 1 : VERIFY_RESETS;
+        for (int i = 0; i < resets; i++)
+        {
+            ReturnToTitle(&pong, &ui, &input);
+            StartPongMatch(&pong, MODE_DEMO, DIFFICULTY_MEDIUM, (unsigned int)i);
+            StepPong(&pong, &input, SIM_TIMESTEP);
+
+            // Win straight away and skip the win screen, so the next step starts a new match
+            pong.scoreL = winScore;
+            StepPong(&pong, &skip, SIM_TIMESTEP);
+            passed &= (pong.playerWon == false);
+        }
+
+        long long grownBytes = (long long)mallinfo2().uordblks - (long long)startInUse;
+        if (round == 1)
+        {
+            printf("  %i resets to the title and %i after wins: heap grew by %lld bytes\n",
+                   VERIFY_RESETS, VERIFY_RESETS, grownBytes);
+            passed &= (grownBytes == 0);
+        }
+    }
+
+    return passed;
+#else
+    printf("  heap use can't be measured here, skipped\n");
+    return true;
+#endif
+}
@@ -5,12 +5,27 @@
 #include "ui.h"
 
 #include <stddef.h>
+#include <stdint.h> // for uint32_t
+#include <string.h> // for strcmp() and strcpy()
 #include "raylib.h"
 #include "raymath.h" // needed for Vector math
 
 #include "config.h"
+#include "pong.h" // needed to set the game difficulty
+#include "render.h" // raylib or the software canvas
 
-#define ARRAY_SIZE(arr) (sizeof(arr) / sizeof((arr)[0]))
+// Types and Structures
+// --------------------------------------------------------------------------------
+typedef struct TextCacheEntry
+{
+    char text[UI_TEXT_CACHE_MAX_LENGTH];
+    int fontSize; // 0 for an empty slot
+    int width;
+} TextCacheEntry;
+
+// Local Variables Definition
+// --------------------------------------------------------------------------------
+static TextCacheEntry textCache[UI_TEXT_CACHE_SIZE];
 
 UiState InitUiState(void)
 {
@@ -22,6 +37,7 @@ UiState InitUiState(void)
         .keyHeldTime = 0.0f,
         .firstFrame = true,
         .autoScroll = false,
+        .needsRedraw = true,
     };
 
     // Title menu buttons
@@ -48,7 +64,7 @@ UiState InitUiState(void)
 UiButton *InitUiText(char *text, UiState *ui, UiMenuId menuId)
 {
     int fontSize = UI_TITLE_SIZE;
-    int textWidth = MeasureText(text, fontSize);
+    int textWidth = MeasureTextCached(text, fontSize);
     float titlePosX = (RENDER_WIDTH - (float)textWidth) / 2;
 #if !defined(PLATFORM_WEB) // different spacing for web
     float titlePosY = UI_TITLE_SPACE_FROM_TOP;
@@ -56,7 +72,8 @@ UiButton *InitUiText(char *text, UiState *ui, UiMenuId menuId)
     float titlePosY = UI_TITLE_SPACE_FROM_TOP + UI_BUTTON_SIZE;
 #endif
 
-    UiButton button = { text, fontSize, { titlePosX, titlePosY }, RAYWHITE };
+    UiButton button = { text, fontSize, { titlePosX, titlePosY }, RAYWHITE, { 0, 0, 0, 0 } };
+    button.bounds = GetUiButtonBounds(&button);
     ui->text[menuId] = button;
 
     return &ui->text[menuId];
@@ -64,32 +81,83 @@ UiButton *InitUiText(char *text, UiState *ui, UiMenuId menuId)
 
 UiButton *InitUiButton(char *text, int fontSize, float textPosX, float textPosY, UiMenu *menu)
 {
-    UiButton button = { text, fontSize, { textPosX, textPosY }, RAYWHITE };
-    menu->buttonCount++;
-    menu->buttons = MemRealloc(menu->buttons, menu->buttonCount * sizeof(UiButton));
-    menu->buttons[menu->buttonCount - 1] = button;
+    if (menu->buttonCount == UI_MAX_BUTTONS)
+    {
+        TraceLog(LOG_WARNING, "UI: [%s] Menu is full, raise UI_MAX_BUTTONS", text);
+        return NULL;
+    }
+
+    UiButton button = { text, fontSize, { textPosX, textPosY }, RAYWHITE, { 0, 0, 0, 0 } };
+    button.bounds = GetUiButtonBounds(&button);
+    menu->buttons[menu->buttonCount++] = button;
 
     return &menu->buttons[menu->buttonCount - 1];
 }
 
 UiButton *InitUiButtonRelative(char* text, UiButton *originButton, float offsetY, UiMenu *menu)
 {
+    if (originButton == NULL) // the one above didn't fit, so neither does this one
+        return NULL;
+
     int fontSize = UI_BUTTON_SIZE;
-    int textWidth = MeasureText(text, fontSize);
+    int textWidth = MeasureTextCached(text, fontSize);
     float textPosX = (RENDER_WIDTH - (float)textWidth) / 2;
     float textPosY = originButton->position.y + originButton->fontSize;
 
     return InitUiButton(text, fontSize, textPosX, textPosY + offsetY, menu);
 }
 
-void FreeUiElements(UiState *ui)
+Rectangle GetUiButtonBounds(const UiButton *button)
 {
-    for (unsigned int i = 0; i < ARRAY_SIZE(ui->menus); i++)
-        MemFree(ui->menus[i].buttons);
+    float width = (float)MeasureTextCached(button->text, button->fontSize);
+    return (Rectangle){ button->position.x - UI_BUTTON_PADDING, button->position.y - UI_BUTTON_PADDING,
+                        width + UI_BUTTON_PADDING * 2, (float)button->fontSize + UI_BUTTON_PADDING * 2 };
+}
+
+int MeasureTextCached(const char *text, int fontSize)
+{
+    // The canvas measures its own copy of the font, which works without a window, and the cache holds raylib's widths
+    if (GetRenderCanvas() != NULL)
+        return RenderMeasureText(text, fontSize);
+
+    // FNV-1a over the text and size
+    uint32_t hash = 2166136261u;
+    size_t length = 0;
+    for (; text[length] != '\0'; length++)
+        hash = (hash ^ (unsigned char)text[length]) * 16777619u;
+    hash = (hash ^ (uint32_t)fontSize) * 16777619u;
+
+    if (length >= UI_TEXT_CACHE_MAX_LENGTH)
+        return MeasureText(text, fontSize);
+
+    // Linear probing, and once the table is full everything is measured directly
+    for (unsigned int probe = 0; probe < UI_TEXT_CACHE_SIZE; probe++)
+    {
+        TextCacheEntry *entry = &textCache[(hash + probe) & (UI_TEXT_CACHE_SIZE - 1)];
+        if (entry->fontSize == fontSize && strcmp(entry->text, text) == 0)
+            return entry->width;
+
+        if (entry->fontSize == 0)
+        {
+            int width = MeasureText(text, fontSize);
+            if (width > 0) // 0 means there's no font yet, so measure again later
+            {
+                strcpy(entry->text, text);
+                entry->fontSize = fontSize;
+                entry->width = width;
+            }
+            return width;
+        }
+    }
+
+    return MeasureText(text, fontSize);
 }
 
 void UpdateUiFrame(UiState *ui, GameState *pong)
 {
+    UiMenuId prevMenu = ui->currentMenu;
+    unsigned int prevId = ui->selectedId;
+
     // Escape or Backspace or Right click to go back
     if ((IsKeyPressed(KEY_ESCAPE) || IsKeyPressed(KEY_BACKSPACE) ||
          IsMouseButtonPressed(MOUSE_RIGHT_BUTTON)) && ui->currentMenu != MENU_TITLE)
@@ -100,6 +168,9 @@ void UpdateUiFrame(UiState *ui, GameState *pong)
 
     UpdateUiCursorSelect(ui, pong);
     UpdateUiCursorMove(ui, pong);
+
+    if (ui->currentMenu != prevMenu || ui->selectedId != prevId)
+        ui->needsRedraw = true;
 }
 
 void UpdateUiCursorMove(UiState *ui, GameState *pong)
@@ -167,7 +238,7 @@ void UpdateUiCursorMove(UiState *ui, GameState *pong)
     // Update auto-scroll timer when holding keys
     if (isInputUp || isInputDown)
     {
-        ui->keyHeldTime += GetFrameTime();
+        ui->keyHeldTime += MIN(GetFrameTime(), 0.1f); // the first frame can be long after waiting for input
         if (ui->keyHeldTime >= autoScrollInitPause)
         {
             ui->autoScroll = true;
@@ -182,7 +253,7 @@ void UpdateUiCursorMove(UiState *ui, GameState *pong)
     ui->firstFrame = false;
 
     if (ui->selectedId != prevId)
-        PlaySound(pong->beeps[BEEP_MENU]);
+        PlayBeep(pong->audio, BEEP_MENU, 1.0f);
 }
 
 void UpdateUiCursorSelect(UiState *ui, GameState *pong)
@@ -228,7 +299,7 @@ void UpdateUiCursorSelect(UiState *ui, GameState *pong)
             else
             {
                 // Main menu -> pong gameplay
-                pong->difficulty = (GameDifficulty)ui->selectedId;
+                SetGameDifficulty(pong, (GameDifficulty)ui->selectedId);
                 pong->currentScreen = SCREEN_GAMEPLAY;
             }
         }
@@ -238,12 +309,9 @@ void UpdateUiCursorSelect(UiState *ui, GameState *pong)
 
 bool IsMouseWithinButton(Vector2 mousePos, UiButton *button)
 {
-    int padding = 20; // extra clickable area around the text
-    int buttonWidth = MeasureText(button->text, button->fontSize);
-    if ((mousePos.x >= button->position.x - padding) &&
-        (mousePos.x <= button->position.x + buttonWidth + padding) &&
-        (mousePos.y >= button->position.y - padding) &&
-        (mousePos.y <= button->position.y + button->fontSize + padding))
+    Rectangle bounds = button->bounds;
+    if ((mousePos.x >= bounds.x) && (mousePos.x <= bounds.x + bounds.width) &&
+        (mousePos.y >= bounds.y) && (mousePos.y <= bounds.y + bounds.height))
         return true;
     else
         return false;
@@ -265,8 +333,8 @@ void DrawUiFrame(UiState *ui, UiMenuId menuId)
 
 void DrawUiElement(UiButton *button)
 {
-    DrawText(button->text, (int)button->position.x, (int)button->position.y,
-             button->fontSize, RAYWHITE);
+    RenderText(button->text, (int)button->position.x, (int)button->position.y,
+               button->fontSize, RAYWHITE);
 }
 
 void DrawUiCursor(UiState *ui)
@@ -280,8 +348,8 @@ void DrawUiCursor(UiState *ui)
     Vector2 cursorOffset = (Vector2){-50.0f, (float)selected->fontSize / 2};
     selectPointPos = Vector2Add(selected->position, cursorOffset);
 
-    DrawTriangle(Vector2Add(selectPointPos, (Vector2){ -size*2, size }),
-                 selectPointPos,
-                 Vector2Add(selectPointPos, (Vector2){ -size*2, -size }),
-                 RAYWHITE);
+    RenderTriangle(Vector2Add(selectPointPos, (Vector2){ -size*2, size }),
+                   selectPointPos,
+                   Vector2Add(selectPointPos, (Vector2){ -size*2, -size }),
+                   RAYWHITE);
 }
@@ -18,6 +18,11 @@
 #define UI_TITLE_SPACE_FROM_TOP 100 // space from the top of the screen
 #define UI_SPACE_FROM_TITLE     200 // space between the first option and title text
 #define UI_BUTTON_SPACING       50  // spacing between each button
+#define UI_BUTTON_PADDING       20  // extra clickable area around the text
+
+// Text width cache, see MeasureTextCached()
+#define UI_TEXT_CACHE_SIZE 64        // Slots, power of two
+#define UI_TEXT_CACHE_MAX_LENGTH 32  // Longer text is measured every time
 
 // Types and Structures
 // --------------------------------------------------------------------------------
@@ -26,17 +31,20 @@
 // --------------------------------------------------------------------------------
 
 // Initialize
-UiState InitUiState(void); // Initializes the title screen and allocates memory for buttons
+UiState InitUiState(void); // Initializes the title screen, no memory to free
 UiButton *InitUiText(char *text, UiState *ui, UiMenuId menuId);
-UiButton *InitUiButton(char *text, int fontSize, float textPosX, float textPosY, UiMenu *menu);
-UiButton *InitUiButtonRelative(char* text, UiButton *originButton, float offsetY, UiMenu *menu);
-void FreeUiElements(UiState *menu); // Releases memory for menu buttons
+UiButton *InitUiButton(char *text, int fontSize, float textPosX, float textPosY, UiMenu *menu); // NULL once the menu is full
+UiButton *InitUiButtonRelative(char* text, UiButton *originButton, float offsetY, UiMenu *menu); // NULL if the menu is full or originButton is NULL
+Rectangle GetUiButtonBounds(const UiButton *button); // Measures the text, so only call it when the text changes
+
+// Text
+int MeasureTextCached(const char *text, int fontSize); // Same as MeasureText(), but each text and size is only measured once
 
 // Update / Input
 void UpdateUiFrame(UiState *ui, GameState *pong); // Updates the menu for the current frame
 void UpdateUiCursorMove(UiState *menu, GameState *pong); // Updates the cursor for movement by user input
 void UpdateUiCursorSelect(UiState *menu, GameState *pong); // Updates the cursor for button selection
-bool IsMouseWithinButton(Vector2 mousePos, UiButton *button);
+bool IsMouseWithinButton(Vector2 mousePos, UiButton *button); // Uses the button's precomputed bounds
 
 // Draw
 void DrawUiFrame(UiState *state, UiMenuId menuId); // Draws the menu for the current frame